@@ -9,13 +9,8 @@
 
 #include "Amiga.h"
 
-//
-// Static class variables
-//
-
-bool Amiga::debugMode = false;
-EventID Amiga::inspectionTarget = INS_NONE;
-
+#include <fcntl.h>
+#include <string>
 
 //
 // Emulator thread
@@ -99,18 +94,21 @@ Amiga::Amiga()
         &cpu,
     };
 
+    pthread_mutex_init(&snapshotLock, NULL);
+
     // Set up initial state
     initialize();
     reset();
-
-    // Initialize the mach timer info
-    mach_timebase_info(&tb);
 }
 
 Amiga::~Amiga()
 {
     debug("Destroying Amiga[%p]\n", this);
     powerOff();
+    
+    // Finish all snapshots that are still in progress
+    worker.waitUntilIdle();
+    pthread_mutex_destroy(&snapshotLock);
 }
 
 void
@@ -206,6 +204,18 @@ Amiga::updateStats()
     stats.disk = paula.diskController.getStats();
     stats.frames++;
 
+    // Measure the emulation speed twice a second
+    uint64_t now = time_in_nanos();
+    uint64_t elapsed = now - speedTimeBase;
+    if (elapsed >= 500000000) {
+
+        fps = (agnus.frame - speedFrameBase) * 1000000000.0 / elapsed;
+        cyclesPerSecond = (agnus.clock - speedClockBase) * 1000000000.0 / elapsed;
+        restartSpeedMeasurement();
+    }
+    stats.fps = fps;
+    stats.cyclesPerSecond = cyclesPerSecond;
+
     pthread_mutex_unlock(&lock);
 }
 
@@ -222,6 +232,14 @@ Amiga::clearStats()
     paula.diskController.clearStats();
 }
 
+void
+Amiga::restartSpeedMeasurement()
+{
+    speedTimeBase = time_in_nanos();
+    speedClockBase = agnus.clock;
+    speedFrameBase = agnus.frame;
+}
+
 bool
 Amiga::configure(ConfigOption option, long value)
 {
@@ -379,6 +397,12 @@ Amiga::configure(ConfigOption option, long value)
             cpu.setSpeed(value);
             break;
 
+        case VA_CPU_BATCH:
+
+            if (current.cpu.batch == value) return true;
+            cpu.setBatch(value);
+            break;
+
         case VA_BLITTER_ACCURACY:
             
             if (current.blitter.accuracy == value) return true;
@@ -390,6 +414,29 @@ Amiga::configure(ConfigOption option, long value)
             if (current.diskController.useFifo == value) return true;
             paula.diskController.setUseFifo(value);
             break;
+            
+        case VA_DISK_WRITE_BACK:
+            
+            if (current.diskController.writeBack == value) return true;
+            paula.diskController.setWriteBack(value);
+            break;
+
+        case VA_AUTO_WARP:
+
+            if (current.diskController.autoWarp == value) return true;
+            paula.diskController.setAutoWarp(value);
+            break;
+
+        case VA_AUTO_WARP_DELAY:
+
+            if (value < 0) {
+                warn("Invalid auto-warp delay: %d\n", value);
+                return false;
+            }
+
+            if (current.diskController.autoWarpDelay == value) return true;
+            paula.diskController.setAutoWarpDelay(value);
+            break;
 
         case VA_SERIAL_DEVICE:
 
@@ -472,7 +519,7 @@ void
 Amiga::prefix() const
 {
     fprintf(stderr, "[%lld] (%3d,%3d) ",
-            agnus.frame, agnus.pos.v, agnus.pos.h);
+            (long long)agnus.frame, agnus.pos.v, agnus.pos.h);
 
     fprintf(stderr, " %06X ", cpu.getPC());
 
@@ -510,6 +557,9 @@ Amiga::reset()
 
     // Discard all previously recorded stastical information
     clearStats();
+    
+    // Discard the rewind history
+    rewindBuffer.clear();
 
     // Inform the GUI
     putMessage(MSG_RESET);
@@ -589,11 +639,13 @@ Amiga::_run()
 void
 Amiga::_pause()
 {
+    pthread_t thread = p;
+
     // Cancel the emulator thread if it still running
-    if (p) signalStop();
+    if (thread) signalStop();
     
     // Wait until the thread has terminated
-    pthread_join(p, NULL);
+    if (thread) pthread_join(thread, NULL);
     
     // Update the recorded debug information
     inspect();
@@ -648,8 +700,8 @@ Amiga::_dump()
              dc.connected[3] ? "yes" : "no", driveTypeName(config.df3.type));
 
     plainmsg("\n");
-    plainmsg("         warp: %d", warp);
-    plainmsg("\n");
+    plainmsg("         warp: %d\n", warp);
+    plainmsg("  unthrottled: %d\n", unthrottled);
 }
 
 void
@@ -738,20 +790,29 @@ Amiga::clearControlFlags(uint32_t flags)
     pthread_mutex_unlock(&lock);
 }
 
+void
+Amiga::setUnthrottled(bool enable)
+{
+    if (unthrottled == enable) return;
+
+    debug("%s unthrottled mode\n", enable ? "Enabling" : "Disabling");
+    unthrottled = enable;
+
+    // Resume pacing from the current position
+    if (!unthrottled) restartTimer();
+}
+
 void
 Amiga::restartTimer()
 {
     timeBase = time_in_nanos();
     clockBase = agnus.clock;
-    
-    // uint64_t kernelNow = mach_absolute_time();
-    // uint64_t nanoNow = abs_to_nanos(kernelNow);
 }
 
 void
 Amiga::synchronizeTiming()
 {
-    uint64_t now        = time_in_nanos();
+    int64_t now         = (int64_t)time_in_nanos();
     Cycle clockDelta    = agnus.clock - clockBase;
     int64_t elapsedTime = (clockDelta * 1000) / masterClockFrequency;
     int64_t targetTime  = timeBase + elapsedTime;
@@ -788,7 +849,7 @@ Amiga::synchronizeTiming()
         }
         
         // See you soon...
-        mach_wait_until(targetTime);
+        waitUntil(targetTime);
         /*
          int64_t jitter = sleepUntil(targetTime, 1500000); // 1.5 usec early wakeup
          if (jitter > 1000000000) { // 1 sec
@@ -813,10 +874,12 @@ Amiga::snapshotIsDue()
 void
 Amiga::loadFromSnapshotUnsafe(Snapshot *snapshot)
 {
+    vector<uint8_t> buffer;
     uint8_t *ptr;
     
-    if (snapshot && (ptr = snapshot->getData())) {
+    if (snapshot && (ptr = snapshot->expand(buffer))) {
         load(ptr);
+        rewindBuffer.clear();
         ping();
     }
 }
@@ -832,12 +895,12 @@ Amiga::loadFromSnapshotSafe(Snapshot *snapshot)
 }
 
 bool
-Amiga::restoreSnapshot(vector<Snapshot *> &storage, unsigned nr)
+Amiga::restoreSnapshot(vector<shared_ptr<Snapshot>> &storage, unsigned nr)
 {
-    Snapshot *snapshot = getSnapshot(storage, nr);
+    shared_ptr<Snapshot> snapshot = getSnapshot(storage, nr);
     
     if (snapshot) {
-        loadFromSnapshotSafe(snapshot);
+        loadFromSnapshotSafe(snapshot.get());
         return true;
     }
     
@@ -865,54 +928,164 @@ Amiga::restoreUserSnapshot(unsigned nr)
 }
 
 size_t
-Amiga::numSnapshots(vector<Snapshot *> &storage)
-{
-    return storage.size();
-}
-
-Snapshot *
-Amiga::getSnapshot(vector<Snapshot *> &storage, unsigned nr)
+Amiga::numSnapshots(vector<shared_ptr<Snapshot>> &storage)
 {
-    return nr < storage.size() ? storage.at(nr) : NULL;
+    pthread_mutex_lock(&snapshotLock);
+    size_t result = storage.size();
+    pthread_mutex_unlock(&snapshotLock);
     
+    return result;
 }
 
-void
-Amiga::takeSnapshot(vector<Snapshot *> &storage)
+shared_ptr<Snapshot>
+Amiga::getSnapshot(vector<shared_ptr<Snapshot>> &storage, unsigned nr)
 {
-    // Delete oldest snapshot if capacity limit has been reached
-    if (storage.size() >= MAX_SNAPSHOTS) {
-        deleteSnapshot(storage, MAX_SNAPSHOTS - 1);
-    }
+    pthread_mutex_lock(&snapshotLock);
+    shared_ptr<Snapshot> result = nr < storage.size() ? storage.at(nr) : NULL;
+    pthread_mutex_unlock(&snapshotLock);
     
-    Snapshot *snapshot = Snapshot::makeWithAmiga(this);
-    storage.insert(storage.begin(), snapshot);
+    return result;
 }
 
 void
 Amiga::takeAutoSnapshot()
 {
-    takeSnapshot(autoSnapshots);
-    putMessage(MSG_AUTOSNAPSHOT_SAVED);
+    // Capture the screenshot and the current state
+    shared_ptr<Snapshot> snapshot(new Snapshot(0));
+    snapshot->takeScreenshot(this);
+    SnapshotImage image = allocateImage(size());
+    save(image->data());
+
+    // Let the background thread compute the delta and store the snapshot
+    worker.dispatch([this, snapshot, image]() {
+        
+        if (!snapshot->makeDelta(image, autoSnapshotBase)) recycleImage(image);
+        
+        pthread_mutex_lock(&snapshotLock);
+        autoSnapshots.insert(autoSnapshots.begin(), snapshot);
+        
+        // Delete the oldest snapshots if a capacity limit has been reached
+        while (autoSnapshots.size() > MAX_AUTO_SNAPSHOTS ||
+               (autoSnapshots.size() > 1 && autoSnapshotBytes() > MAX_AUTO_SNAPSHOT_BYTES)) {
+            autoSnapshots.pop_back();
+        }
+        pthread_mutex_unlock(&snapshotLock);
+        
+        putMessage(MSG_AUTOSNAPSHOT_SAVED);
+    });
 }
 
 void
 Amiga::takeUserSnapshot()
 {
     debug("takeUserSnapshot");
-    takeSnapshot(userSnapshots);
-    putMessage(MSG_USERSNAPSHOT_SAVED);
+    
+    // Capture the current state
+    shared_ptr<Snapshot> snapshot(Snapshot::makeWithAmiga(this));
+    
+    // Let the background thread store the snapshot
+    worker.dispatch([this, snapshot]() {
+        
+        pthread_mutex_lock(&snapshotLock);
+        userSnapshots.insert(userSnapshots.begin(), snapshot);
+        
+        // Delete the oldest snapshot if the capacity limit has been reached
+        if (userSnapshots.size() > MAX_SNAPSHOTS) userSnapshots.pop_back();
+        pthread_mutex_unlock(&snapshotLock);
+        
+        putMessage(MSG_USERSNAPSHOT_SAVED);
+    });
 }
 
 void
-Amiga::deleteSnapshot(vector<Snapshot *> &storage, unsigned index)
+Amiga::saveSnapshotToFile(const char *path)
 {
-    Snapshot *snapshot = getSnapshot(storage, index);
+    // Capture the screenshot and the current state
+    suspend();
+    Snapshot *snapshot = new Snapshot(0);
+    snapshot->takeScreenshot(this);
+    SnapshotImage image = allocateImage(size());
+    save(image->data());
+    resume();
     
-    if (snapshot) {
+    // Use the captured image as the base of a delta without any changes
+    SnapshotImage base;
+    snapshot->makeDelta(image, base);
+    
+    // Compress the snapshot and write it to disk in the background
+    std::string name = path;
+    worker.dispatch([this, snapshot, image, name]() {
+        
+        bool success = false;
+        int fd = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        
+        if (fd >= 0) {
+            success = snapshot->writeCompressed(fd);
+            success &= close(fd) == 0;
+        }
         delete snapshot;
+        recycleImage(image);
+        
+        putMessage(success ? MSG_SNAPSHOT_WRITTEN : MSG_SNAPSHOT_WRITE_ERROR);
+    });
+}
+
+void
+Amiga::deleteSnapshot(vector<shared_ptr<Snapshot>> &storage, unsigned index)
+{
+    pthread_mutex_lock(&snapshotLock);
+    
+    // The snapshot is freed when the last reference is gone
+    if (index < storage.size()) {
         storage.erase(storage.begin() + index);
     }
+    
+    pthread_mutex_unlock(&snapshotLock);
+}
+
+size_t
+Amiga::autoSnapshotBytes()
+{
+    size_t result = 0;
+    SnapshotImage base;
+    
+    for (shared_ptr<Snapshot> &snapshot : autoSnapshots) {
+        
+        result += snapshot->getSize() + snapshot->deltaSize();
+        
+        // Snapshots sharing a base image are stored next to each other
+        if (snapshot->getBase() != base) {
+            base = snapshot->getBase();
+            result += base ? base->size() : 0;
+        }
+    }
+    return result;
+}
+
+SnapshotImage
+Amiga::allocateImage(size_t size)
+{
+    SnapshotImage image;
+    
+    pthread_mutex_lock(&snapshotLock);
+    if (!imagePool.empty()) {
+        image = imagePool.back();
+        imagePool.pop_back();
+    }
+    pthread_mutex_unlock(&snapshotLock);
+    
+    if (!image) image = SnapshotImage(new vector<uint8_t>(size));
+    image->resize(size);
+    
+    return image;
+}
+
+void
+Amiga::recycleImage(SnapshotImage image)
+{
+    pthread_mutex_lock(&snapshotLock);
+    if (imagePool.size() < 2) imagePool.push_back(image);
+    pthread_mutex_unlock(&snapshotLock);
 }
 
 
@@ -930,7 +1103,7 @@ void
 Amiga::threadDidTerminate()
 {
     debug(2, "Emulator thread terminated\n");
-    p = NULL;
+    p = (pthread_t)0;
     
     /* Put emulator into pause mode. If we got here by a call to pause(), the
      * following (reentrant) call to pause() has no effect. If we got here
@@ -966,8 +1139,12 @@ Amiga::runLoop()
 {
     debug(RUNLOOP_DEBUG, "runLoop()\n");
 
+    // Bind the CPU core to this thread
+    cpu.makeActiveInstance();
+
     // Prepare to run
     restartTimer();
+    restartSpeedMeasurement();
     
     // Enable or disable debugging features
     debugMode ? setControlFlags(RL_DEBUG) : clearControlFlags(RL_DEBUG);
@@ -976,8 +1153,13 @@ Amiga::runLoop()
     // Enter the loop
     do {
         
-        // Emulate the next CPU instruction
-        Cycle newClock = cpu.executeInstruction();
+        // Emulate the CPU up to the next synchronization point
+        Cycle newClock;
+        if (cpu.getConfig().batch && !(runLoopCtrl & RL_DEBUG)) {
+            newClock = cpu.executeInstructions(agnus.nextTrigger);
+        } else {
+            newClock = cpu.executeInstruction();
+        }
 
         // Emulate Agnus up to the same cycle
         agnus.executeUntil(newClock);
@@ -991,6 +1173,12 @@ Amiga::runLoop()
                 clearControlFlags(RL_SNAPSHOT);
             }
             
+            // Are we requested to record the current state?
+            if (runLoopCtrl & RL_RECORD) {
+                recordRewindState();
+                clearControlFlags(RL_RECORD);
+            }
+            
             // Are we requested to update the debugger info structs?
             if (runLoopCtrl & RL_INSPECT) {
                 inspect();
@@ -1023,6 +1211,61 @@ Amiga::runLoop()
     } while (1);
 }
 
+bool
+Amiga::rewindIsDue()
+{
+    return rewindInterval > 0 && agnus.frame % rewindInterval == 0;
+}
+
+void
+Amiga::setRewindInterval(long frames)
+{
+    suspend();
+    rewindInterval = MAX(frames, 0);
+    rewindBuffer.clear();
+    resume();
+}
+
+void
+Amiga::setRewindBudget(size_t bytes)
+{
+    suspend();
+    rewindBuffer.setCapacity(bytes);
+    resume();
+}
+
+Frame
+Amiga::rewindDepth()
+{
+    return numRewindStates() ? agnus.frame - rewindBuffer.oldestFrame() : 0;
+}
+
+void
+Amiga::recordRewindState()
+{
+    uint8_t *buffer = rewindBuffer.prepare(size());
+    
+    save(buffer);
+    rewindBuffer.commit(agnus.frame);
+}
+
+bool
+Amiga::rewind(long frames)
+{
+    const uint8_t *state;
+    
+    suspend();
+    
+    if ((state = rewindBuffer.rewind(agnus.frame - frames))) {
+        load((uint8_t *)state);
+        ping();
+    }
+    
+    resume();
+    
+    return state != NULL;
+}
+
 void
 Amiga::dumpClock()
 {
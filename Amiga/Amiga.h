@@ -39,6 +39,8 @@
 #include "RomFile.h"
 #include "ExtFile.h"
 #include "Snapshot.h"
+#include "RewindBuffer.h"
+#include "BackgroundWorker.h"
 #include "ADFFile.h"
 
 /* A complete virtual Amiga
@@ -65,7 +67,7 @@ public:
      * If the event is EVENT_NONE, no action is taken. If an INS_xxx event is
      * scheduled, inspect() is called on a certain Amiga component.
      */
-    static EventID inspectionTarget;
+    EventID inspectionTarget = INS_NONE;
     
 private:
     
@@ -75,7 +77,7 @@ private:
      * are performed that are usually left out. E.g., the CPU checks for
      * breakpoints and records the executed instruction in it's trace buffer.
      */
-    static bool debugMode;
+    bool debugMode = false;
     
     
     //
@@ -154,6 +156,13 @@ public:
      * terminates, depending on the set flags.
      */
     uint32_t runLoopCtrl = 0;
+
+    /* Frame limit
+     * If this value is greater than 0, the run loop terminates automatically
+     * when Agnus has completed the specified frame. The headless runner uses
+     * this feature to emulate a fixed number of frames.
+     */
+    Frame stopFrame = 0;
     
 private:
     
@@ -161,7 +170,7 @@ private:
     unsigned suspendCounter = 0;
     
     // The emulator thread
-    pthread_t p = NULL;
+    pthread_t p = (pthread_t)0;
     
     
     //
@@ -170,11 +179,6 @@ private:
     
 private:
     
-    /* System timer information
-     * Used to match the emulation speed with the speed of a real Amiga.
-     */
-    mach_timebase_info_data_t tb;
-    
     /* Inside restartTimer(), the current time and the DMA clock cylce
      * are recorded in these variables. They are used in sychronizeTiming()
      * to determine how long the thread has to sleep.
@@ -182,6 +186,26 @@ private:
     Cycle clockBase = 0;
     uint64_t timeBase = 0;
 
+    /* Indicates if the emulator runs unthrottled.
+     * In unthrottled mode, synchronizeTiming() is never called. Hence, the
+     * emulator thread never sleeps and runs as fast as the host allows. In
+     * contrast to warp mode, audio playback is not affected.
+     */
+    bool unthrottled = false;
+
+    /* Speed measurement
+     * The emulation speed is measured in regular intervals inside
+     * updateStats(). These variables record the host time, the DMA clock and
+     * the frame number at the beginning of the current measurement interval.
+     */
+    uint64_t speedTimeBase = 0;
+    Cycle speedClockBase = 0;
+    Frame speedFrameBase = 0;
+
+    // Most recently measured emulation speed
+    double fps = 0.0;
+    double cyclesPerSecond = 0.0;
+
     
     //
     // Message queue
@@ -210,12 +234,47 @@ private:
     
     // Maximum number of stored snapshots
     static const size_t MAX_SNAPSHOTS = 32;
+    static const size_t MAX_AUTO_SNAPSHOTS = 256;
+    
+    // Maximum number of bytes occupied by all auto-snapshots
+    static const size_t MAX_AUTO_SNAPSHOT_BYTES = MB(64);
     
-    // Storage for auto-taken snapshots
-    vector<Snapshot *> autoSnapshots;
+    /* Storage for auto-taken snapshots (stored as deltas)
+     * Snapshots are reference counted. A snapshot handed out by getSnapshot()
+     * stays valid even if it is deleted from the storage in the meantime.
+     */
+    vector<shared_ptr<Snapshot>> autoSnapshots;
+
+    // Base image of the most recent auto-snapshot
+    SnapshotImage autoSnapshotBase;
     
     // Storage for user-taken snapshots
-    vector<Snapshot *> userSnapshots;
+    vector<shared_ptr<Snapshot>> userSnapshots;
+    
+    // Recycled core data images for taking auto-snapshots
+    vector<SnapshotImage> imagePool;
+    
+    // Mutex guarding the snapshot storage and the image pool
+    pthread_mutex_t snapshotLock;
+    
+    /* Background thread for finishing snapshots.
+     * Capturing a snapshot only copies the emulator state. Delta encoding,
+     * compression, and file I/O are carried out by this thread.
+     */
+    BackgroundWorker worker;
+    
+    
+    //
+    // Rewind history
+    //
+    
+    /* Number of frames between two recorded states.
+     * Recording is disabled if this value is zero.
+     */
+    long rewindInterval = 0;
+    
+    // Recorded states for stepping back in time
+    RewindBuffer rewindBuffer;
     
     
     //
@@ -237,7 +296,7 @@ public:
     ~Amiga();
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
 
     }
@@ -306,6 +365,13 @@ public:
     // Clears all previously recorded statistical information
     void clearStats();
 
+private:
+
+    // Starts a new speed measurement interval
+    void restartSpeedMeasurement();
+
+public:
+
     //
     // Accessing properties
     //
@@ -369,6 +435,7 @@ public:
     void signalSnapshot() { setControlFlags(RL_SNAPSHOT); }
     void signalInspect() { setControlFlags(RL_INSPECT); }
     void signalStop() { setControlFlags(RL_STOP); }
+    void signalRecord() { setControlFlags(RL_RECORD); }
 
     
     //
@@ -446,6 +513,12 @@ public:
     
 public:
 
+    // Indicates if the emulator runs unthrottled.
+    bool getUnthrottled() { return unthrottled; }
+
+    // Enables or disables unthrottled mode.
+    void setUnthrottled(bool enable);
+
     /* Restarts the synchronization timer.
      * This function is invoked at launch time to initialize the timer and
      * reinvoked when the synchronization timer got out of sync.
@@ -454,14 +527,8 @@ public:
     
 private:
     
-    // Converts kernel time to nanoseconds.
-    uint64_t abs_to_nanos(uint64_t abs) { return abs * tb.numer / tb.denom; }
-    
-    // Converts nanoseconds to kernel time.
-    uint64_t nanos_to_abs(uint64_t nanos) { return nanos * tb.denom / tb.numer; }
-    
     // Returns the current time in nanoseconds.
-    uint64_t time_in_nanos() { return abs_to_nanos(mach_absolute_time()); }
+    uint64_t time_in_nanos() { return timeInNanos(); }
     
     /* Returns the delay between two frames in nanoseconds.
      * As long as we only emulate PAL machines, the frame rate is 50 Hz
@@ -515,7 +582,7 @@ public:
     void loadFromSnapshotSafe(Snapshot *snapshot);
     
     // Restores a certain snapshot from the snapshot storage
-    bool restoreSnapshot(vector<Snapshot *> &storage, unsigned nr);
+    bool restoreSnapshot(vector<shared_ptr<Snapshot>> &storage, unsigned nr);
     bool restoreAutoSnapshot(unsigned nr);
     bool restoreUserSnapshot(unsigned nr);
     
@@ -524,32 +591,100 @@ public:
     bool restoreLatestUserSnapshot() { return restoreUserSnapshot(0); }
     
     // Returns the number of stored snapshots
-    size_t numSnapshots(vector<Snapshot *> &storage);
+    size_t numSnapshots(vector<shared_ptr<Snapshot>> &storage);
     size_t numAutoSnapshots() { return numSnapshots(autoSnapshots); }
     size_t numUserSnapshots() { return numSnapshots(userSnapshots); }
     
     // Returns an snapshot from the snapshot storage
-    Snapshot *getSnapshot(vector<Snapshot *> &storage, unsigned nr);
-    Snapshot *autoSnapshot(unsigned nr) { return getSnapshot(autoSnapshots, nr); }
-    Snapshot *userSnapshot(unsigned nr) { return getSnapshot(userSnapshots, nr); }
+    shared_ptr<Snapshot> getSnapshot(vector<shared_ptr<Snapshot>> &storage, unsigned nr);
+    shared_ptr<Snapshot> autoSnapshot(unsigned nr) { return getSnapshot(autoSnapshots, nr); }
+    shared_ptr<Snapshot> userSnapshot(unsigned nr) { return getSnapshot(userSnapshots, nr); }
     
     /* Takes a snapshot and inserts it into the snapshot storage
-     * The new snapshot is inserted at position 0 and all others are moved one
-     * position up. If the buffer is full, the oldest snapshot is deleted. Make
-     * sure to call the 'Safe' version outside the emulator thread.
+     * The emulator state is captured right away. The snapshot is finished and
+     * inserted by the background thread which reports completion by
+     * MSG_AUTOSNAPSHOT_SAVED or MSG_USERSNAPSHOT_SAVED. The new snapshot is
+     * inserted at position 0 and all others are moved one position up. If the
+     * buffer is full, the oldest snapshot is deleted. Make sure to call the
+     * 'Safe' version outside the emulator thread.
      */
-    void takeSnapshot(vector<Snapshot *> &storage);
     void takeAutoSnapshot();
     void takeUserSnapshot();
     void takeAutoSnapshotSafe() { suspend(); takeAutoSnapshot(); resume(); }
     void takeUserSnapshotSafe() { suspend(); takeUserSnapshot(); resume(); }
     
+    /* Takes a snapshot and writes it to a file in the background.
+     * Completion is reported by MSG_SNAPSHOT_WRITTEN or
+     * MSG_SNAPSHOT_WRITE_ERROR. The emulator state is copied into a pooled
+     * image first and compressed afterwards. Compressing the components
+     * while saving them would avoid the copy, but would keep the emulator
+     * suspended until the whole file has been written.
+     */
+    void saveSnapshotToFile(const char *path);
+    
+    // Blocks until all snapshots have been processed by the background thread
+    void waitForSnapshots() { worker.waitUntilIdle(); }
+    
+private:
+    
+    /* Returns the number of bytes occupied by all auto-snapshots
+     * Shared base images are counted once. The caller must hold snapshotLock.
+     */
+    size_t autoSnapshotBytes();
+    
+    // Returns a core data image of the specified size from the image pool
+    SnapshotImage allocateImage(size_t size);
+    
+    // Returns a core data image to the image pool
+    void recycleImage(SnapshotImage image);
+    
+public:
+    
     // Deletes a snapshot from the snapshot storage
-    void deleteSnapshot(vector<Snapshot *> &storage, unsigned nr);
+    void deleteSnapshot(vector<shared_ptr<Snapshot>> &storage, unsigned nr);
     void deleteAutoSnapshot(unsigned nr) { deleteSnapshot(autoSnapshots, nr); }
     void deleteUserSnapshot(unsigned nr) { deleteSnapshot(userSnapshots, nr); }
     
     
+    //
+    // Rewinding
+    //
+    
+public:
+    
+    // Returns true if the current state should be recorded in this frame.
+    bool rewindIsDue();
+    
+    // Returns the number of frames between two recorded states.
+    long getRewindInterval() { return rewindInterval; }
+    
+    /* Sets the number of frames between two recorded states.
+     * Pass 0 to disable recording. Changing the value deletes the history.
+     */
+    void setRewindInterval(long frames);
+    
+    // Returns the memory budget of the rewind buffer in bytes.
+    size_t getRewindBudget() { return rewindBuffer.getCapacity(); }
+    
+    // Sets the memory budget of the rewind buffer and deletes the history.
+    void setRewindBudget(size_t bytes);
+    
+    // Returns the number of recorded states.
+    size_t numRewindStates() { return rewindBuffer.count(); }
+    
+    // Returns the number of frames the emulator can step back.
+    Frame rewindDepth();
+    
+    // Records the current state in the rewind buffer.
+    void recordRewindState();
+    
+    /* Steps back in time by the specified number of frames.
+     * The emulator is set back to the most recent recorded state that is not
+     * newer than the target frame. Returns false if no such state exists.
+     */
+    bool rewind(long frames);
+    
+    
     //
     // Debugging the emulator
     //
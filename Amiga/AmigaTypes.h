@@ -45,8 +45,12 @@ typedef enum : long
     VA_FILTER_TYPE,
     VA_CPU_ENGINE,
     VA_CPU_SPEED,
+    VA_CPU_BATCH,
     VA_BLITTER_ACCURACY,
     VA_FIFO_BUFFERING,
+    VA_DISK_WRITE_BACK,
+    VA_AUTO_WARP,
+    VA_AUTO_WARP_DELAY,
     VA_SERIAL_DEVICE
 }
 ConfigOption;
@@ -58,13 +62,14 @@ inline bool isConfigOption(long value)
 
 typedef enum
 {
-    RL_SNAPSHOT           = 0b00001,
-    RL_INSPECT            = 0b00010,
-    RL_ENABLE_TRACING     = 0b00100,
-    RL_ENABLE_BREAKPOINTS = 0b01000,
-    RL_STOP               = 0b10000,
+    RL_SNAPSHOT           = 0b000001,
+    RL_INSPECT            = 0b000010,
+    RL_ENABLE_TRACING     = 0b000100,
+    RL_ENABLE_BREAKPOINTS = 0b001000,
+    RL_STOP               = 0b010000,
+    RL_RECORD             = 0b100000,
     
-    RL_DEBUG              = 0b01100
+    RL_DEBUG              = 0b001100
 }
 RunLoopControlFlag;
 
@@ -113,6 +118,10 @@ typedef struct
     UARTStats uart;
     DiskControllerStats disk;
     long frames;
+
+    // Emulation speed (measured in frames and master cycles per second)
+    double fps;
+    double cyclesPerSecond;
 }
 AmigaStats;
 
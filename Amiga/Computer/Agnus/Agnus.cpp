@@ -47,11 +47,11 @@ Agnus::initBplEventTableLores()
         for (int i = 0; i <= 0xD8; i += 8, p += 8) {
 
             switch(bpu) {
-                case 6: p[2] = BPL_L6;
-                case 5: p[6] = BPL_L5;
-                case 4: p[1] = BPL_L4;
-                case 3: p[5] = BPL_L3;
-                case 2: p[3] = BPL_L2;
+                case 6: p[2] = BPL_L6; [[fallthrough]];
+                case 5: p[6] = BPL_L5; [[fallthrough]];
+                case 4: p[1] = BPL_L4; [[fallthrough]];
+                case 3: p[5] = BPL_L3; [[fallthrough]];
+                case 2: p[3] = BPL_L2; [[fallthrough]];
                 case 1: p[7] = BPL_L1;
             }
         }
@@ -80,9 +80,9 @@ Agnus::initBplEventTableHires()
             switch(bpu) {
                 case 6:
                 case 5:
-                case 4: p[0] = p[4] = BPL_H4;
-                case 3: p[2] = p[6] = BPL_H3;
-                case 2: p[1] = p[5] = BPL_H2;
+                case 4: p[0] = p[4] = BPL_H4; [[fallthrough]];
+                case 3: p[2] = p[6] = BPL_H3; [[fallthrough]];
+                case 2: p[1] = p[5] = BPL_H2; [[fallthrough]];
                 case 1: p[3] = p[7] = BPL_H1;
             }
         }
@@ -179,6 +179,7 @@ void Agnus::_reset()
 
     // Initialize statistical counters
     clearStats();
+    clearEventProfile();
 
     // Initialize event tables
     clearBplEventTable();
@@ -471,6 +472,32 @@ Agnus::doDiskDMA(uint16_t value)
     stats.count[BUS_DISK]++;
 }
 
+void
+Agnus::doDiskDMAFromMemory(uint8_t *dst, long count)
+{
+    assert(count > 0);
+
+    mem.peekChipBlock(dskpt, dst, count);
+    INC_CHIP_PTR_BY(dskpt, 2 * count);
+
+    busOwner[pos.h] = BUS_DISK;
+    busValue[pos.h] = HI_LO(dst[2 * count - 2], dst[2 * count - 1]);
+    stats.count[BUS_DISK] += count;
+}
+
+void
+Agnus::doDiskDMAToMemory(const uint8_t *src, long count)
+{
+    assert(count > 0);
+
+    mem.pokeChipBlock(dskpt, src, count);
+    INC_CHIP_PTR_BY(dskpt, 2 * count);
+
+    busOwner[pos.h] = BUS_DISK;
+    busValue[pos.h] = HI_LO(src[2 * count - 2], src[2 * count - 1]);
+    stats.count[BUS_DISK] += count;
+}
+
 uint16_t
 Agnus::doAudioDMA(int channel)
 {
@@ -748,13 +775,13 @@ Agnus::updateDasJumpTable(int16_t end)
 }
 
 bool
-Agnus::isLastLx(int16_t dmaCycle)
+Agnus::isLastLx(int16_t )
 {
     return (pos.h >= dmaStopLores - 8);
 }
 
 bool
-Agnus::isLastHx(int16_t dmaCycle)
+Agnus::isLastHx(int16_t )
 {
     return (pos.h >= dmaStopHires - 4);
 }
@@ -1205,7 +1232,7 @@ Agnus::pokeVHPOS(uint16_t value)
 uint16_t
 Agnus::peekVPOSR()
 {
-    uint16_t id;
+    uint16_t id = 0;
 
     // 15 14 13 12 11 10 09 08 07 06 05 04 03 02 01 00
     // LF I6 I5 I4 I3 I2 I1 I0 -- -- -- -- -- -- -- V8
@@ -1227,7 +1254,7 @@ Agnus::peekVPOSR()
 }
 
 void
-Agnus::pokeVPOS(uint16_t value)
+Agnus::pokeVPOS(uint16_t )
 {
     // Don't know what to do here ...
 }
@@ -1778,22 +1805,30 @@ Agnus::executeUntil(Cycle targetClock)
     // Align to DMA cycle raster
     targetClock &= ~0b111;
 
-    // Compute the number of DMA cycles to execute
-    DMACycle dmaCycles = (targetClock - clock) / DMA_CYCLES(1);
+    while (clock < targetClock) {
 
-    if (targetClock < nextTrigger && dmaCycles > 0) {
+        if (nextTrigger <= clock) {
 
-        // Advance directly to the target clock
-        clock = targetClock;
-        pos.h += dmaCycles;
+            // Serve all pending events and advance by a single DMA cycle
+            execute();
+            stats.steppedCycles++;
 
-        // If this assertion hits, the HSYNC event hasn't been served
-        assert(pos.h <= HPOS_CNT);
+        } else {
 
-    } else {
+            /* Jump to the DMA cycle where the next event is served. All
+             * cycles in between are idle. Hence, only the clock and the
+             * horizontal counter need to be updated.
+             */
+            Cycle next = MIN((nextTrigger + 0b111) & ~0b111, targetClock);
+            DMACycle dmaCycles = (next - clock) / DMA_CYCLES(1);
 
-        // Execute DMA cycles one after another
-        for (DMACycle i = 0; i < dmaCycles; i++) execute();
+            clock = next;
+            pos.h += dmaCycles;
+            stats.skippedCycles += dmaCycles;
+
+            // If this assertion hits, the HSYNC event hasn't been served
+            assert(pos.h <= HPOS_CNT);
+        }
     }
 }
 #endif
@@ -1801,7 +1836,7 @@ Agnus::executeUntil(Cycle targetClock)
 #ifdef SLOW_BLT_DEBUG
 
 void
-Agnus::executeUntilBusIsFree() { }
+Agnus::executeUntilBusIsFree() { if (cpu.isBatching()) cpu.endBatch(); }
 
 #else
 
@@ -1888,6 +1923,9 @@ Agnus::executeUntilBusIsFree()
 {
     int16_t oldpos;
 
+    // Catch up with the CPU if it is running ahead
+    if (cpu.isBatching()) cpu.endBatch();
+
     // Quick-exit if CPU runs at full speed during blit operations
     if (blitter.getAccuracy() == 0) return;
 
@@ -2173,8 +2211,14 @@ Agnus::vsyncHandler()
     // Prepare to take a snapshot once in a while
     if (amiga.snapshotIsDue()) amiga.signalSnapshot();
 
+    // Record the current state for the rewind history
+    if (amiga.rewindIsDue()) amiga.signalRecord();
+
+    // Terminate the run loop if the frame limit has been reached
+    if (amiga.stopFrame && frame >= amiga.stopFrame) amiga.signalStop();
+
     // Count some sheep (zzzzzz) ...
-    if (!amiga.getWarp()) {
+    if (!amiga.getWarp() && !amiga.getUnthrottled()) {
         amiga.synchronizeTiming();
     }
 }
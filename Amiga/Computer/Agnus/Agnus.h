@@ -68,6 +68,9 @@ class Agnus : public SubComponent {
     AgnusInfo info;
     EventInfo eventInfo;
 
+    // Service counts and times of all events (if EVENT_PROFILE is defined)
+    EventProfile eventProfile;
+
     // Statistics shown in the GUI monitor panel
      AgnusStats stats;
 
@@ -527,7 +530,7 @@ public:
     void initDasEventTable();
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
     }
 
@@ -612,7 +615,7 @@ public:
     AgnusRevision getRevision() { return config.revision; }
     void setRevision(AgnusRevision type);
 
-    bool isOCS() { return config.revision = AGNUS_8367; }
+    bool isOCS() { return config.revision == AGNUS_8367; }
     bool isECS() { return config.revision != AGNUS_8367; }
 
     // Returns the maximum amout of Chip Ram in KB this Agnus can handle
@@ -636,6 +639,9 @@ private:
     void inspectEvents();
     void inspectEventSlot(EventSlot nr);
 
+    // Returns a textual description of an event
+    static const char *eventName(EventSlot nr, EventID id);
+
 public:
 
     void dumpEvents();
@@ -651,6 +657,15 @@ public:
     // Resets the collected statistical information
     void clearStats() { memset(&stats, 0, sizeof(stats)); }
 
+    // Returns the collected event profile (requires EVENT_PROFILE)
+    EventProfile getEventProfile();
+
+    // Resets the collected event profile
+    void clearEventProfile() { memset(&eventProfile, 0, sizeof(eventProfile)); }
+
+    // Writes the collected event profile in CSV format
+    void dumpEventProfile(FILE *file);
+
 
     //
     // Examining the current frame
@@ -787,6 +802,10 @@ public:
 
     uint16_t doDiskDMA();
 
+    // Performs multiple disk DMA transfers in a single bus cycle
+    void doDiskDMAFromMemory(uint8_t *dst, long count);
+    void doDiskDMAToMemory(const uint8_t *src, long count);
+
     template <int channel> uint16_t doSpriteDMA();
 
     // OLD
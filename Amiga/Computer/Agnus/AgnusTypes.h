@@ -191,6 +191,10 @@ AgnusInfo;
 typedef struct
 {
     long count[BUS_OWNER_COUNT];
+
+    // DMA cycles emulated one by one and DMA cycles skipped in executeUntil()
+    long steppedCycles;
+    long skippedCycles;
 }
 AgnusStats;
 
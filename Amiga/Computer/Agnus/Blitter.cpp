@@ -12,30 +12,6 @@
 Blitter::Blitter(Amiga& ref) : SubComponent(ref)
 {
     setDescription("Blitter");
-    
-    // Initialize fill pattern lookup tables
-    
-    // Inclusive fill
-    for (unsigned carryIn = 0; carryIn < 2; carryIn++) {
-        
-        for (unsigned byte = 0; byte < 256; byte++) {
-            
-            uint8_t carry = carryIn;
-            uint8_t inclPattern = byte;
-            uint8_t exclPattern = byte;
-            
-            for (int bit = 0; bit < 8; bit++) {
-                
-                inclPattern |= carry << bit; // inclusive fill
-                exclPattern ^= carry << bit; // exclusive fill
-                
-                if (byte & (1 << bit)) carry = !carry;
-            }
-            fillPattern[0][carryIn][byte] = inclPattern;
-            fillPattern[1][carryIn][byte] = exclPattern;
-            nextCarryIn[carryIn][byte] = carry;
-        }
-    }
 }
 
 void
@@ -281,9 +257,9 @@ Blitter::pokeBLTCON0L(uint16_t value)
     debug(BLTREG_DEBUG, "pokeBLTCON0L(%X)\n", value);
 
     // This is an ECS only register
-    if (agnus.isECS()) return;
+    if (agnus.isOCS()) return;
 
-    REPLACE_LO(bltcon0, LO_BYTE(value));
+    bltcon0 = REPLACE_LO(bltcon0, LO_BYTE(value));
 }
 
 void
@@ -749,17 +725,19 @@ Blitter::doFill(uint16_t &data, bool &carry)
 
     debug(BLT_DEBUG, "data = %X carry = %X\n", data, carry);
     
-    uint8_t dataHi = HI_BYTE(data);
-    uint8_t dataLo = LO_BYTE(data);
-    uint8_t exclusive = !!bltconEFE();
-    
-    // Remember: A fill operation is carried out from right to left
-    uint8_t resultLo = fillPattern[exclusive][carry][dataLo];
-    carry = nextCarryIn[carry][dataLo];
-    uint8_t resultHi = fillPattern[exclusive][carry][dataHi];
-    carry = nextCarryIn[carry][dataHi];
-    
-    data = HI_LO(resultHi, resultLo);
+    /* Remember: A fill operation is carried out from right to left. The
+     * carry into a bit is the carry into the word, XORed with all bits to the
+     * right. Hence, the carry bits are obtained by a prefix XOR.
+     */
+    uint16_t prefix = data;
+    prefix ^= prefix << 1;
+    prefix ^= prefix << 2;
+    prefix ^= prefix << 4;
+    prefix ^= prefix << 8;
+
+    uint16_t fill = (uint16_t)(prefix << 1) ^ (carry ? 0xFFFF : 0);
+    data = bltconEFE() ? (data ^ fill) : (data | fill);
+    carry ^= prefix >> 15;
 }
 
 void
@@ -14,6 +14,14 @@ Copper::Copper(Amiga& ref) : SubComponent(ref)
     setDescription("Copper");
 }
 
+void
+Copper::_reset()
+{
+    RESET_SNAPSHOT_ITEMS
+
+    clearCache();
+}
+
 void
 Copper::_inspect()
 {
@@ -136,6 +144,9 @@ Copper::pokeCOPINS(uint16_t value)
     }
     */
     cop1ins = value;
+
+    // The instruction register no longer matches the fetched instruction
+    clearCache();
 }
 
 void
@@ -198,6 +209,12 @@ Copper::switchToCopperList(int nr)
     // debug("switchToCopperList(%d) coppc: %x -> %x\n", nr, coppc, (nr == 1) ? cop1lc : cop2lc);
     coppc = (nr == 1) ? cop1lc : cop2lc;
     copList = nr;
+
+    // Start over if the list has moved
+    if (cacheBase[nr - 1] != (coppc & mem.chipMask)) {
+        cacheBase[nr - 1] = coppc & mem.chipMask;
+        cacheCnt[nr - 1] = 0;
+    }
     agnus.scheduleRel<COP_SLOT>(0, COP_REQ_DMA);
 
     /*
@@ -207,6 +224,53 @@ Copper::switchToCopperList(int nr)
     */
 }
 
+const CopperInstr *
+Copper::cachedInstr(uint32_t addr)
+{
+    int nr = copList - 1;
+    uint32_t offset = (addr & mem.chipMask) - cacheBase[nr];
+
+    if (offset < 4 * cacheCnt[nr] && !(offset & 3)) {
+        return &cache[nr][offset / 4];
+    }
+    return NULL;
+}
+
+const CopperInstr *
+Copper::decodeInstr(uint32_t addr)
+{
+    if (const CopperInstr *instr = cachedInstr(addr)) {
+
+        assert(instr->ins1 == cop1ins);
+        assert(instr->ins2 == cop2ins);
+        return instr;
+    }
+
+    int nr = copList - 1;
+    addr &= mem.chipMask;
+    CopperInstr *instr = &uncached;
+
+    /* Only append the instruction if it directly follows the cached ones.
+     * Because a write between the two fetches is not covered by the cache,
+     * the words are compared with the current memory contents, too.
+     */
+    if (addr - cacheBase[nr] == 4 * cacheCnt[nr] &&
+        cacheCnt[nr] < COP_CACHE_SIZE &&
+        mem.peekChip16(addr) == cop1ins &&
+        mem.peekChip16((addr + 2) & mem.chipMask) == cop2ins) {
+
+        instr = &cache[nr][cacheCnt[nr]++];
+    }
+
+    instr->ins1 = cop1ins;
+    instr->ins2 = cop2ins;
+    instr->move = isMoveCmd();
+    instr->wait = isWaitCmd();
+    instr->reg = getRA();
+
+    return instr;
+}
+
 bool
 Copper::findMatch(Beam &result)
 {
@@ -215,16 +279,16 @@ Copper::findMatch(Beam &result)
     // Get the current beam position
     Beam b = agnus.pos;
 
-    // Set up the comparison positions
-    int16_t vComp = getVP();
-    int16_t hComp = getHP();
-
     // Set up the comparison masks
-    int16_t vMask = getVM() | 0x80;
-    int16_t hMask = getHM() & 0xFE;
+    uint8_t vMask = getVM() | 0x80;
+    uint8_t hMask = getHM() & 0xFE;
+
+    // Set up the comparison positions
+    uint8_t vComp = getVP() & vMask;
+    uint8_t hComp = getHP() & hMask;
 
     // Check if the current line is already below the vertical trigger position
-    if ((b.v & vMask) > (vComp & vMask)) {
+    if ((b.v & vMask) > vComp) {
 
         // Success. The current position already matches
         result = b;
@@ -232,7 +296,7 @@ Copper::findMatch(Beam &result)
     }
 
     // Check if the current line matches the vertical trigger position
-    if ((b.v & vMask) == (vComp & vMask)) {
+    if ((b.v & vMask) == vComp) {
 
         // Check if we find a horizontal match in this line
         if (findHorizontalMatch(b.h, hComp, hMask, hMatch)) {
@@ -244,11 +308,26 @@ Copper::findMatch(Beam &result)
         }
     }
 
-    // Find the first vertical match below the current line
-    if (!findVerticalMatch(b.v + 1, vComp, vMask, vMatch)) return false;
+    /* Below the current line, the first match is either at the horizontal
+     * match position of the first line that matches vertically, or at the
+     * beginning of the first line that is greater. If a matching line has no
+     * horizontal match, none of them has, and we need a greater line.
+     */
+    if (findHorizontalMatch(0, hComp, hMask, hMatch)) {
 
-    // Find the first horizontal match in that line
-    if (!findHorizontalMatch(0, hComp, hMask, hMatch)) return false;
+        if (!findVerticalMatch(b.v + 1, vComp, vMask, vMatch)) return false;
+        if ((vMatch & vMask) > vComp) hMatch = 0;
+
+    } else {
+
+        // Determine the next greater comparison value
+        uint8_t vNext = (uint8_t)(vComp | ~vMask) + 1;
+        if (vNext == 0) return false;
+        vComp = vNext & vMask;
+
+        if (!findVerticalMatch(b.v + 1, vComp, vMask, vMatch)) return false;
+        hMatch = 0;
+    }
 
     // Success. We've found a match below the current line
     result.v = vMatch;
@@ -261,14 +340,16 @@ Copper::findVerticalMatch(int16_t vStrt, int16_t vComp, int16_t vMask, int16_t &
 {
     int16_t vStop = agnus.frameInfo.numLines;
 
-    // Iterate through all vertical positions
-    for (int v = vStrt; v < vStop; v++) {
-
-        // Check if the comparator triggers at this position
-        if ((v & vMask) >= (vComp & vMask)) {
-            result = v;
-            return true;
-        }
+    /* The comparator only sees the lower eight bits of the vertical beam
+     * position. Hence, we search lines 0 to 255 and the lines above 255
+     * separately.
+     */
+    if (vStrt < 256 && (result = firstMatch(vStrt, MIN(vStop, 256), vComp, vMask)) >= 0) {
+        return true;
+    }
+    if (vStop > 256 && (result = firstMatch(MAX(vStrt, 256) - 256, vStop - 256, vComp, vMask)) >= 0) {
+        result += 256;
+        return true;
     }
     return false;
 }
@@ -276,84 +357,31 @@ Copper::findVerticalMatch(int16_t vStrt, int16_t vComp, int16_t vMask, int16_t &
 bool
 Copper::findHorizontalMatch(int16_t hStrt, int16_t hComp, int16_t hMask, int16_t &result)
 {
-    int16_t hStop = HPOS_CNT;
-
-    debug("findHorizontalMatch(%X,%X,%X)\n", hStrt, hComp, hMask);
-
-    // Iterate through all horizontal positions
-    for (int h = hStrt; h < hStop; h++) {
-
-        // Check if the comparator triggers at this position
-        if ((h & hMask) >= (hComp & hMask)) {
-            result = h;
-            return true;
-        }
-    }
-    return false;
+    return (result = firstMatch(hStrt, HPOS_CNT, hComp, hMask)) >= 0;
 }
 
-bool
-Copper::findMatchNew(Beam &match)
+int16_t
+Copper::firstMatch(int16_t start, int16_t end, uint8_t comp, uint8_t mask)
 {
-    // Start searching at the current beam position
-    uint32_t beam = (agnus.pos.v << 8) | agnus.pos.h;
-
-    // Get the comparison position and the comparison mask
-    uint32_t comp = getVPHP();
-    uint32_t mask = getVMHM();
-
-    // Iterate through all lines starting from the current position
-    while ((beam >> 8) < agnus.frameInfo.numLines) {
-
-        // Check if the vertical components are equal
-        if ((beam & mask & ~0xFF) == (comp & mask & ~0xFF)) {
-
-            // debug("Matching vertically: beam = %X comp = %X mask = %X\n", beam, comp, mask);
-
-            // Try to match the horizontal coordinate as well
-            if (findHorizontalMatchNew(beam, comp, mask)) {
-
-                // Success
-                match.v = beam >> 8;
-                match.h = beam & 0xFF;
-                return true;
-            }
-        }
-
-        // Check if the vertical beam position is greater
-        else if ((beam & mask & ~0xFF) > (comp & mask & ~0xFF)) {
-
-            // Success
-            match.v = beam >> 8;
-            match.h = beam & 0xFF;
-            return true;
-        }
-
-        // Jump to the beginning of the next line
-        beam = (beam & ~0xFF) + 0x100;
-    }
-
-    return false;
-}
-
-bool
-Copper::findHorizontalMatchNew(uint32_t &match, uint32_t comp, uint32_t mask)
-{
-    int16_t hStop = HPOS_CNT;
+    assert((comp & ~mask) == 0);
+    assert(start >= 0 && end <= 256);
+    
+    if (start >= end) return -1;
 
-    // Iterate through all horizontal positions
-    for (uint32_t beam = match; (beam & 0xFF) < hStop; beam++) {
+    uint8_t masked = start & mask;
 
-        // Check if the comparator triggers at this position
-        if ((beam & mask) >= (comp & mask)) {
+    // Check if the start value already matches
+    if (masked >= comp) return start;
 
-            // Success
-            match = beam;
-            return true;
-        }
-    }
+    /* Find the most significant bit where the masked start value differs from
+     * the comparison value. At this bit, the comparison value has a 1 and the
+     * start value has a 0. The smallest greater value that matches keeps all
+     * bits above, sets this bit, and copies the lower bits from 'comp'.
+     */
+    int bit = 31 - __builtin_clz(masked ^ comp);
+    int16_t result = (start & ~((2 << bit) - 1)) | (1 << bit) | (comp & ((1 << bit) - 1));
 
-    return false;
+    return result < end ? result : -1;
 }
 
 void
@@ -479,7 +507,7 @@ Copper::scheduleWaitWakeup()
     Beam trigger;
 
     // Find the trigger position for this WAIT command
-    if (findMatchNew(trigger)) {
+    if (findMatch(trigger)) {
 
         // In how many cycles do we get there?
         int delay = trigger - agnus.pos;
@@ -627,6 +655,7 @@ Copper::isIllegalInstr(uint32_t addr)
 void
 Copper::serviceEvent(EventID id)
 {
+    const CopperInstr *instr;
     uint16_t reg;
     Beam beam;
 
@@ -657,7 +686,7 @@ Copper::serviceEvent(EventID id)
 
             // Load the first instruction word
             cop1ins = agnus.copperRead(coppc);
-            // coppcBase = coppc;
+            instr = cachedInstr(coppc);
             advancePC();
 
             // Dynamically determine the end of the Copper list
@@ -668,7 +697,12 @@ Copper::serviceEvent(EventID id)
             }
 
             // Fork execution depending on the instruction type
-            schedule(isMoveCmd() ? COP_MOVE : COP_WAIT_OR_SKIP);
+            if (instr) {
+                assert(instr->ins1 == cop1ins);
+                schedule(instr->move ? COP_MOVE : COP_WAIT_OR_SKIP);
+            } else {
+                schedule(isMoveCmd() ? COP_MOVE : COP_WAIT_OR_SKIP);
+            }
             break;
             
         case COP_MOVE:
@@ -680,10 +714,11 @@ Copper::serviceEvent(EventID id)
 
             // Load the second instruction word
             cop2ins = agnus.copperRead(coppc);
+            instr = decodeInstr(coppc - 2);
             advancePC();
 
             // Extract register number from the first instruction word
-            reg = (cop1ins & 0x1FE);
+            reg = instr->reg;
 
             // Stop the Copper if address is illegal
             if (isIllegalAddress(reg)) { agnus.cancel<COP_SLOT>(); break; }
@@ -718,10 +753,11 @@ Copper::serviceEvent(EventID id)
 
             // Load the second instruction word
             cop2ins = agnus.copperRead(coppc);
+            instr = decodeInstr(coppc - 2);
             advancePC();
 
             // Fork execution depending on the instruction type
-            schedule(isWaitCmd() ? COP_WAIT1 : COP_SKIP1);
+            schedule(instr->wait ? COP_WAIT1 : COP_SKIP1);
             break;
 
         case COP_WAIT1:
@@ -923,7 +959,7 @@ Copper::disassemble(uint32_t addr)
     sprintf(pos, "($%02X,$%02X)", getVP(addr), getHP(addr));
     
     if (getVM(addr) == 0xFF && getHM(addr) == 0xFF) {
-        sprintf(mask, "");
+        mask[0] = 0;
     } else {
         sprintf(mask, ", ($%02X,$%02X)", getHM(addr), getVM(addr));
     }
@@ -12,6 +12,24 @@
 
 #include "Beam.h"
 
+// A Copper instruction in decoded form
+struct CopperInstr
+{
+    // The two instruction words as fetched from memory
+    uint16_t ins1;
+    uint16_t ins2;
+
+    // Instruction type (SKIP if neither flag is set)
+    bool move;
+    bool wait;
+
+    // Target register of a MOVE instruction
+    uint16_t reg;
+};
+
+// Number of decoded instructions kept per Copper list
+static const uint32_t COP_CACHE_SIZE = 1024;
+
 class Copper : public SubComponent
 {
     friend class Agnus;
@@ -56,6 +74,20 @@ class Copper : public SubComponent
     // Storage for disassembled instruction
     char disassembly[128];
 
+    /* Decoded instruction cache
+     * For each Copper list, the decoded forms of the executed instructions
+     * are stored in ascending order, starting at the Chip Ram offset the list
+     * was entered at. The cache is keyed by the value of cop1lc or cop2lc at
+     * the time of the jump and covers cacheCnt[i] instructions. Writes into
+     * the covered range truncate the cache in front of the modified word.
+     */
+    CopperInstr cache[2][COP_CACHE_SIZE];
+    uint32_t cacheBase[2] = { 0, 0 };
+    uint32_t cacheCnt[2] = { 0, 0 };
+
+    // Decoded form of uncached instructions
+    CopperInstr uncached;
+
 public:
 
     // Indicates if Copper is currently servicing an event (for debugging only)
@@ -74,7 +106,7 @@ public:
     Copper(Amiga& ref);
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
     }
 
@@ -102,7 +134,7 @@ public:
     
 private:
 
-    void _reset() override { RESET_SNAPSHOT_ITEMS }
+    void _reset() override;
     void _inspect() override; 
     void _dump() override;
     size_t _size() override { COMPUTE_SNAPSHOT_SIZE }
@@ -123,10 +155,44 @@ public:
     uint32_t getCopPC() const { return coppc; }
 
 
+    //
+    // Caching decoded instructions
+    //
+
+public:
+
+    // Discards all decoded instructions
+    void clearCache() { cacheCnt[0] = cacheCnt[1] = 0; }
+
+    /* Informs the Copper about a write into Chip Ram.
+     * 'addr' is a Chip Ram offset and 'bytes' the size of the written range.
+     */
+    void didWriteChip(uint32_t addr, uint32_t bytes = 2) {
+        for (int i = 0; i < 2; i++) {
+            if (addr - cacheBase[i] < 4 * cacheCnt[i] || cacheBase[i] - addr < bytes) {
+                cacheCnt[i] = addr > cacheBase[i] ? (addr - cacheBase[i]) / 4 : 0;
+            }
+        }
+    }
+
+private:
+
+    // Returns the cached instruction starting at 'addr' or NULL
+    const CopperInstr *cachedInstr(uint32_t addr);
+
+    /* Returns the decoded form of the instruction in cop1ins and cop2ins,
+     * which has been fetched from 'addr'. The instruction is decoded and
+     * appended to the cache if it is not cached yet.
+     */
+    const CopperInstr *decodeInstr(uint32_t addr);
+
+
     //
     // Accessing registers
     //
 
+public:
+
     void pokeCOPCON(uint16_t value);
     template <PokeSource s> void pokeCOPJMP1();
     template <PokeSource s> void pokeCOPJMP2();
@@ -162,14 +228,18 @@ private:
      *        Variable 'result' remains untouched.
      */
     bool findMatch(Beam &result);
-    bool findMatchNew(Beam &result);
 
     // Called by findMatch() to determine the vertical trigger position
     bool findVerticalMatch(int16_t vStrt, int16_t vComp, int16_t vMask, int16_t &result);
 
     // Called by findMatch() to determine the horizontal trigger position
     bool findHorizontalMatch(int16_t hStrt, int16_t hComp, int16_t hMask, int16_t &result);
-    bool findHorizontalMatchNew(uint32_t &beam, uint32_t comp, uint32_t mask);
+
+    /* Computes the smallest value x in [start; end) with (x & mask) >= comp.
+     * All values are 8 bit wide and 'comp' must not have bits outside 'mask'.
+     * Returns -1 if no such value exists.
+     */
+    static int16_t firstMatch(int16_t start, int16_t end, uint8_t comp, uint8_t mask);
 
     // Emulates the Copper writing a value into one of the custom registers
     void move(int addr, uint16_t value);
@@ -69,7 +69,7 @@ DmaDebugger::setEnabled(bool value)
 }
 
 bool
-DmaDebugger::isVisualized(BusOwner owner)
+DmaDebugger::isVisualized(BusOwner )
 {
     return true;
 }
@@ -133,7 +133,7 @@ DmaDebugger::computeOverlay()
     uint16_t *values = agnus.busValue;
     int *ptr = denise.pixelEngine.pixelAddr(0);
 
-    double bgWeight, fgWeight;
+    double bgWeight = 0.0, fgWeight = 0.0;
 
     switch (displayMode) {
 
@@ -59,230 +59,225 @@ Agnus::inspectEventSlot(EventSlot nr)
         i->frameRel = -1;
     }
 
-    switch ((EventSlot)nr) {
+    i->eventName = eventName(nr, slot[nr].id);
+}
+
+const char *
+Agnus::eventName(EventSlot nr, EventID id)
+{
+    assert(isEventSlot(nr));
+
+    switch (nr) {
 
         case REG_SLOT:
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case REG_CHANGE:    i->eventName = "REG_CHANGE"; break;
-                // case REG_HSYNC:     i->eventName = "REG_HSYNC"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case REG_CHANGE:    return "REG_CHANGE";
+                // case REG_HSYNC:     return "REG_HSYNC";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case RAS_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case RAS_HSYNC:     i->eventName = "RAS_HSYNC"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case RAS_HSYNC:     return "RAS_HSYNC";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case CIAA_SLOT:
         case CIAB_SLOT:
 
-            switch (slot[nr].id) {
-                case 0:             i->eventName = "none"; break;
-                case CIA_EXECUTE:   i->eventName = "CIA_EXECUTE"; break;
-                case CIA_WAKEUP:    i->eventName = "CIA_WAKEUP"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+            switch (id) {
+                case 0:             return "none";
+                case CIA_EXECUTE:   return "CIA_EXECUTE";
+                case CIA_WAKEUP:    return "CIA_WAKEUP";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case BPL_SLOT:
 
-            switch (slot[nr].id) {
-                case 0:             i->eventName = "none"; break;
-                case BPL_L1:        i->eventName = "BPL_L1"; break;
-                case BPL_L2:        i->eventName = "BPL_L2"; break;
-                case BPL_L3:        i->eventName = "BPL_L3"; break;
-                case BPL_L4:        i->eventName = "BPL_L4"; break;
-                case BPL_L5:        i->eventName = "BPL_L5"; break;
-                case BPL_L6:        i->eventName = "BPL_L6"; break;
-                case BPL_H1:        i->eventName = "BPL_H1"; break;
-                case BPL_H2:        i->eventName = "BPL_H2"; break;
-                case BPL_H3:        i->eventName = "BPL_H3"; break;
-                case BPL_H4:        i->eventName = "BPL_H4"; break;
-                case BPL_EOL:       i->eventName = "BPL_EOL"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+            switch (id) {
+                case 0:             return "none";
+                case BPL_L1:        return "BPL_L1";
+                case BPL_L2:        return "BPL_L2";
+                case BPL_L3:        return "BPL_L3";
+                case BPL_L4:        return "BPL_L4";
+                case BPL_L5:        return "BPL_L5";
+                case BPL_L6:        return "BPL_L6";
+                case BPL_H1:        return "BPL_H1";
+                case BPL_H2:        return "BPL_H2";
+                case BPL_H3:        return "BPL_H3";
+                case BPL_H4:        return "BPL_H4";
+                case BPL_EOL:       return "BPL_EOL";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case DAS_SLOT:
 
-            switch (slot[nr].id) {
-                case 0:             i->eventName = "none"; break;
-                case DAS_REFRESH:   i->eventName = "DAS_REFRESH"; break;
-                case DAS_D0:        i->eventName = "DAS_D0"; break;
-                case DAS_D1:        i->eventName = "DAS_D1"; break;
-                case DAS_D2:        i->eventName = "DAS_D2"; break;
-                case DAS_A0:        i->eventName = "DAS_A0"; break;
-                case DAS_A1:        i->eventName = "DAS_A1"; break;
-                case DAS_A2:        i->eventName = "DAS_A2"; break;
-                case DAS_A3:        i->eventName = "DAS_A3"; break;
-                case DAS_S0_1:      i->eventName = "DAS_S0_1"; break;
-                case DAS_S0_2:      i->eventName = "DAS_S0_2"; break;
-                case DAS_S1_1:      i->eventName = "DAS_S1_1"; break;
-                case DAS_S1_2:      i->eventName = "DAS_S1_2"; break;
-                case DAS_S2_1:      i->eventName = "DAS_S2_2"; break;
-                case DAS_S3_1:      i->eventName = "DAS_S3_1"; break;
-                case DAS_S3_2:      i->eventName = "DAS_S3_2"; break;
-                case DAS_S4_1:      i->eventName = "DAS_S4_1"; break;
-                case DAS_S4_2:      i->eventName = "DAS_S4_2"; break;
-                case DAS_S5_1:      i->eventName = "DAS_S5_1"; break;
-                case DAS_S5_2:      i->eventName = "DAS_S5_2"; break;
-                case DAS_S6_1:      i->eventName = "DAS_S6_1"; break;
-                case DAS_S6_2:      i->eventName = "DAS_S6_2"; break;
-                case DAS_S7_1:      i->eventName = "DAS_S7_1"; break;
-                case DAS_S7_2:      i->eventName = "DAS_S7_2"; break;
-                case DAS_SDMA:      i->eventName = "DAS_SDMA"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+            switch (id) {
+                case 0:             return "none";
+                case DAS_REFRESH:   return "DAS_REFRESH";
+                case DAS_D0:        return "DAS_D0";
+                case DAS_D1:        return "DAS_D1";
+                case DAS_D2:        return "DAS_D2";
+                case DAS_A0:        return "DAS_A0";
+                case DAS_A1:        return "DAS_A1";
+                case DAS_A2:        return "DAS_A2";
+                case DAS_A3:        return "DAS_A3";
+                case DAS_S0_1:      return "DAS_S0_1";
+                case DAS_S0_2:      return "DAS_S0_2";
+                case DAS_S1_1:      return "DAS_S1_1";
+                case DAS_S1_2:      return "DAS_S1_2";
+                case DAS_S2_1:      return "DAS_S2_1";
+                case DAS_S2_2:      return "DAS_S2_2";
+                case DAS_S3_1:      return "DAS_S3_1";
+                case DAS_S3_2:      return "DAS_S3_2";
+                case DAS_S4_1:      return "DAS_S4_1";
+                case DAS_S4_2:      return "DAS_S4_2";
+                case DAS_S5_1:      return "DAS_S5_1";
+                case DAS_S5_2:      return "DAS_S5_2";
+                case DAS_S6_1:      return "DAS_S6_1";
+                case DAS_S6_2:      return "DAS_S6_2";
+                case DAS_S7_1:      return "DAS_S7_1";
+                case DAS_S7_2:      return "DAS_S7_2";
+                case DAS_SDMA:      return "DAS_SDMA";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case COP_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:                i->eventName = "none"; break;
-                case COP_REQ_DMA:      i->eventName = "COP_REQ_DMA"; break;
-                case COP_FETCH:        i->eventName = "COP_FETCH"; break;
-                case COP_MOVE:         i->eventName = "COP_MOVE"; break;
-                case COP_WAIT_OR_SKIP: i->eventName = "WAIT_OR_SKIP"; break;
-                case COP_WAIT1:        i->eventName = "COP_WAIT1"; break;
-                case COP_WAIT2:        i->eventName = "COP_WAIT2"; break;
-                case COP_WAIT_BLIT:    i->eventName = "COP_WAIT_BLIT"; break;
-                case COP_SKIP1:        i->eventName = "COP_SKIP1"; break;
-                case COP_SKIP2:        i->eventName = "COP_SKIP1"; break;
-                case COP_JMP1:         i->eventName = "COP_JMP1"; break;
-                case COP_JMP2:         i->eventName = "COP_JMP2"; break;
-                default:               i->eventName = "*** INVALID ***"; break;
+                case 0:                return "none";
+                case COP_REQ_DMA:      return "COP_REQ_DMA";
+                case COP_FETCH:        return "COP_FETCH";
+                case COP_MOVE:         return "COP_MOVE";
+                case COP_WAIT_OR_SKIP: return "WAIT_OR_SKIP";
+                case COP_WAIT1:        return "COP_WAIT1";
+                case COP_WAIT2:        return "COP_WAIT2";
+                case COP_WAIT_BLIT:    return "COP_WAIT_BLIT";
+                case COP_SKIP1:        return "COP_SKIP1";
+                case COP_SKIP2:        return "COP_SKIP2";
+                case COP_JMP1:         return "COP_JMP1";
+                case COP_JMP2:         return "COP_JMP2";
+                default:               return "*** INVALID ***";
             }
-            break;
 
         case BLT_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case BLT_STRT1:     i->eventName = "BLT_STRT1"; break;
-                case BLT_STRT2:     i->eventName = "BLT_STRT2"; break;
-                case BLT_EXEC_SLOW: i->eventName = "BLT_EXEC_SLOW"; break;
-                case BLT_EXEC_FAST: i->eventName = "BLT_EXEC_FAST"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case BLT_STRT1:     return "BLT_STRT1";
+                case BLT_STRT2:     return "BLT_STRT2";
+                case BLT_EXEC_SLOW: return "BLT_EXEC_SLOW";
+                case BLT_EXEC_FAST: return "BLT_EXEC_FAST";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SEC_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case SEC_TRIGGER:   i->eventName = "SEC_TRIGGER"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case SEC_TRIGGER:   return "SEC_TRIGGER";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case DSK_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case DSK_ROTATE:    i->eventName = "DSK_ROTATE"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case DSK_ROTATE:    return "DSK_ROTATE";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case DCH_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case DCH_INSERT:    i->eventName = "DCH_INSERT"; break;
-                case DCH_EJECT:     i->eventName = "DCH_EJECT"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case DCH_INSERT:    return "DCH_INSERT";
+                case DCH_EJECT:     return "DCH_EJECT";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case IRQ_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case IRQ_CHECK:     i->eventName = "IRQ_CHECK"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case IRQ_CHECK:     return "IRQ_CHECK";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case KBD_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case KBD_SELFTEST:  i->eventName = "KBD_SELFTEST"; break;
-                case KBD_SYNC:      i->eventName = "KBD_SYNC"; break;
-                case KBD_STRM_ON:   i->eventName = "KBD_STRM_ON"; break;
-                case KBD_STRM_OFF:  i->eventName = "KBD_STRM_OFF"; break;
-                case KBD_TIMEOUT:   i->eventName = "KBD_TIMEOUT"; break;
-                case KBD_SEND:      i->eventName = "KBD_SEND"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case KBD_SELFTEST:  return "KBD_SELFTEST";
+                case KBD_SYNC:      return "KBD_SYNC";
+                case KBD_STRM_ON:   return "KBD_STRM_ON";
+                case KBD_STRM_OFF:  return "KBD_STRM_OFF";
+                case KBD_TIMEOUT:   return "KBD_TIMEOUT";
+                case KBD_SEND:      return "KBD_SEND";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case TXD_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case TXD_BIT:       i->eventName = "TXD_BIT"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case TXD_BIT:       return "TXD_BIT";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case RXD_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case RXD_BIT:       i->eventName = "RXD_BIT"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case RXD_BIT:       return "RXD_BIT";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case POT_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case POT_DISCHARGE: i->eventName = "POT_DISCHARGE"; break;
-                case POT_CHARGE:    i->eventName = "POT_CHARGE"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case POT_DISCHARGE: return "POT_DISCHARGE";
+                case POT_CHARGE:    return "POT_CHARGE";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case INS_SLOT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i->eventName = "none"; break;
-                case INS_NONE:      i->eventName = "INS_NONE"; break;
-                case INS_AMIGA:     i->eventName = "INS_AMIGA"; break;
-                case INS_CPU:       i->eventName = "INS_CPU"; break;
-                case INS_MEM:       i->eventName = "INS_MEM"; break;
-                case INS_CIA:       i->eventName = "INS_CIA"; break;
-                case INS_AGNUS:     i->eventName = "INS_AGNUS"; break;
-                case INS_PAULA:     i->eventName = "INS_PAULA"; break;
-                case INS_DENISE:    i->eventName = "INS_DENISE"; break;
-                case INS_PORTS:     i->eventName = "INS_PORTS"; break;
-                case INS_EVENTS:    i->eventName = "INS_EVENTS"; break;
-                default:            i->eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case INS_NONE:      return "INS_NONE";
+                case INS_AMIGA:     return "INS_AMIGA";
+                case INS_CPU:       return "INS_CPU";
+                case INS_MEM:       return "INS_MEM";
+                case INS_CIA:       return "INS_CIA";
+                case INS_AGNUS:     return "INS_AGNUS";
+                case INS_PAULA:     return "INS_PAULA";
+                case INS_DENISE:    return "INS_DENISE";
+                case INS_PORTS:     return "INS_PORTS";
+                case INS_EVENTS:    return "INS_EVENTS";
+                default:            return "*** INVALID ***";
             }
-            break;
 
-        default: assert(false);
+        default:
+            assert(false);
+            return "*** INVALID ***";
     }
 }
 
@@ -336,6 +331,38 @@ Agnus::getEventSlotInfo(int nr)
     return result;
 }
 
+EventProfile
+Agnus::getEventProfile()
+{
+    EventProfile result;
+
+    pthread_mutex_lock(&lock);
+    result = eventProfile;
+    pthread_mutex_unlock(&lock);
+
+    return result;
+}
+
+void
+Agnus::dumpEventProfile(FILE *file)
+{
+    EventProfile profile = getEventProfile();
+
+    fprintf(file, "slot,event,count,nanos\n");
+    for (unsigned s = 0; s < SLOT_COUNT; s++) {
+        for (unsigned id = 0; id < MAX_EVENT_IDS; id++) {
+
+            if (profile.count[s][id] == 0) continue;
+
+            fprintf(file, "%s,%s,%ld,%llu\n",
+                    slotName((EventSlot)s),
+                    eventName((EventSlot)s, (EventID)id),
+                    profile.count[s][id],
+                    (unsigned long long)profile.nanos[s][id]);
+        }
+    }
+}
+
 void
 Agnus::scheduleNextBplEvent(int16_t hpos)
 {
@@ -398,67 +425,95 @@ Agnus::scheduleNextREGEvent()
     scheduleAbs<REG_SLOT>(nextTrigger, REG_CHANGE);
 }
 
+/* Services a due event. If EVENT_PROFILE is defined, the call is wrapped by
+ * code recording how often the event has been serviced and how long it took.
+ * The time is also summed up in profiledNanos which is used to exclude the
+ * time spent in the secondary slots from the time of SEC_SLOT.
+ */
+#ifdef EVENT_PROFILE
+#define PROFILE(s,x) { \
+EventID id = slot[s].id; \
+assert(id < MAX_EVENT_IDS); \
+uint64_t start = timeInNanos(); \
+x; \
+uint64_t elapsed = timeInNanos() - start; \
+eventProfile.count[s][id]++; \
+eventProfile.nanos[s][id] += elapsed; \
+profiledNanos += elapsed; }
+#else
+#define PROFILE(s,x) { x; }
+#endif
+
 void
 Agnus::executeEventsUntil(Cycle cycle) {
 
+#ifdef EVENT_PROFILE
+    uint64_t profiledNanos = 0;
+#endif
+
     //
     // Check primary slots
     //
 
     if (isDue<REG_SLOT>(cycle)) {
-        serviceREGEvent(cycle);
+        PROFILE(REG_SLOT, serviceREGEvent(cycle));
     }
     if (isDue<RAS_SLOT>(cycle)) {
-        serviceRASEvent();
+        PROFILE(RAS_SLOT, serviceRASEvent());
     }
     if (isDue<CIAA_SLOT>(cycle)) {
-        serviceCIAEvent<0>();
+        PROFILE(CIAA_SLOT, serviceCIAEvent<0>());
     }
     if (isDue<CIAB_SLOT>(cycle)) {
-        serviceCIAEvent<1>();
+        PROFILE(CIAB_SLOT, serviceCIAEvent<1>());
     }
     if (isDue<BPL_SLOT>(cycle)) {
-        serviceBPLEvent();
+        PROFILE(BPL_SLOT, serviceBPLEvent());
     }
     if (isDue<DAS_SLOT>(cycle)) {
-        serviceDASEvent();
+        PROFILE(DAS_SLOT, serviceDASEvent());
     }
     if (isDue<COP_SLOT>(cycle)) {
-        copper.serviceEvent(slot[COP_SLOT].id);
+        PROFILE(COP_SLOT, copper.serviceEvent(slot[COP_SLOT].id));
     }
     if (isDue<BLT_SLOT>(cycle)) {
-        blitter.serviceEvent(slot[BLT_SLOT].id);
+        PROFILE(BLT_SLOT, blitter.serviceEvent(slot[BLT_SLOT].id));
     }
 
     if (isDue<SEC_SLOT>(cycle)) {
 
+#ifdef EVENT_PROFILE
+        uint64_t secStart = timeInNanos();
+        uint64_t secNested = profiledNanos;
+#endif
+
         //
         // Check secondary slots
         //
 
         if (isDue<DSK_SLOT>(cycle)) {
-            paula.diskController.serviceDiskEvent();
+            PROFILE(DSK_SLOT, paula.diskController.serviceDiskEvent());
         }
         if (isDue<DCH_SLOT>(cycle)) {
-            paula.diskController.serviceDiskChangeEvent(slot[DCH_SLOT].id, (int)slot[DCH_SLOT].data);
+            PROFILE(DCH_SLOT, paula.diskController.serviceDiskChangeEvent(slot[DCH_SLOT].id, (int)slot[DCH_SLOT].data));
         }
         if (isDue<IRQ_SLOT>(cycle)) {
-            paula.serviceIrqEvent();
+            PROFILE(IRQ_SLOT, paula.serviceIrqEvent());
         }
         if (isDue<KBD_SLOT>(cycle)) {
-            amiga.keyboard.serviceKeyboardEvent(slot[KBD_SLOT].id);
+            PROFILE(KBD_SLOT, amiga.keyboard.serviceKeyboardEvent(slot[KBD_SLOT].id));
         }
         if (isDue<TXD_SLOT>(cycle)) {
-            uart.serveTxdEvent(slot[TXD_SLOT].id);
+            PROFILE(TXD_SLOT, uart.serveTxdEvent(slot[TXD_SLOT].id));
         }
         if (isDue<RXD_SLOT>(cycle)) {
-            uart.serveRxdEvent(slot[RXD_SLOT].id);
+            PROFILE(RXD_SLOT, uart.serveRxdEvent(slot[RXD_SLOT].id));
         }
         if (isDue<POT_SLOT>(cycle)) {
-            paula.servePotEvent(slot[POT_SLOT].id);
+            PROFILE(POT_SLOT, paula.servePotEvent(slot[POT_SLOT].id));
         }
         if (isDue<INS_SLOT>(cycle)) {
-            serviceINSEvent();
+            PROFILE(INS_SLOT, serviceINSEvent());
         }
 
         // Determine the next trigger cycle for all secondary slots
@@ -469,6 +524,14 @@ Agnus::executeEventsUntil(Cycle cycle) {
 
         // Update the secondary table trigger in the primary table
         rescheduleAbs<SEC_SLOT>(nextSecTrigger);
+
+#ifdef EVENT_PROFILE
+        eventProfile.count[SEC_SLOT][SEC_TRIGGER]++;
+        // Only count the time not already recorded for the secondary slots
+        secNested = profiledNanos - secNested;
+        eventProfile.nanos[SEC_SLOT][SEC_TRIGGER] +=
+        timeInNanos() - secStart - secNested;
+#endif
     }
 
     // Determine the next trigger cycle for all primary slots
@@ -293,4 +293,18 @@ typedef struct
 }
 EventInfo;
 
+// Largest number of event IDs in a single slot (the DAS slot has the most)
+#define MAX_EVENT_IDS DAS_EVENT_COUNT
+
+typedef struct
+{
+    // Number of times an event has been serviced
+    long count[SLOT_COUNT][MAX_EVENT_IDS];
+
+    // Accumulated host time spent in the event handler (nanoseconds). For
+    // SEC_SLOT, the time spent in the secondary slots is not included.
+    uint64_t nanos[SLOT_COUNT][MAX_EVENT_IDS];
+}
+EventProfile;
+
 #endif
@@ -8,6 +8,7 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "sse_utils.h"
 
 void
 Blitter::initFastBlitter()
@@ -108,6 +109,130 @@ void Blitter::doFastCopyBlit()
     aold = 0;
     bold = 0;
 
+#ifdef __SSSE3__
+
+    /* Each row is processed in blocks of words. A block is fetched from Chip
+     * Ram in one go, passed through the data path with vector instructions,
+     * and written back in one go.
+     */
+    const long maxBlock = 128;
+    uint16_t bufA[maxBlock + 8], bufB[maxBlock + 8], bufC[maxBlock + 8], bufD[maxBlock + 8];
+    uint16_t *a = bufA + 1, *b = bufB + 1, *c = bufC, *d = bufD;
+    uint8_t minterm = bltcon0 & 0xFF;
+
+    // Returns the number of words up to the end (or start) of Chip Ram
+    auto contiguous = [&](uint32_t pt) {
+        return desc ? (long)(pt >> 1) + 1 : (long)((mem.chipMask + 1 - pt) >> 1);
+    };
+
+    // Returns the number of words that can be read before D overwrites one
+    auto independent = [&](uint32_t pt) {
+        long delta = (long)(((desc ? pt - dpt : dpt - pt) & mem.chipMask) >> 1);
+        return delta ? delta : maxBlock;
+    };
+
+    // Returns a pointer to the lowest address of a block
+    auto block = [&](uint32_t pt, long count) {
+        return mem.chip + (desc ? pt - 2 * (count - 1) : pt);
+    };
+
+    for (int y = 0; y < bltsizeH; y++) {
+
+        // Reset the fill carry bit
+        fillCarry = !!bltconFCI();
+
+        for (long x = 0, count; x < bltsizeW; x += count) {
+
+            // Determine the block size
+            count = MIN(maxBlock, bltsizeW - x);
+            if (useA) count = MIN(count, contiguous(apt));
+            if (useB) count = MIN(count, contiguous(bpt));
+            if (useC) count = MIN(count, contiguous(cpt));
+            if (useD) {
+                count = MIN(count, contiguous(dpt));
+                if (useA) count = MIN(count, independent(apt));
+                if (useB) count = MIN(count, independent(bpt));
+                if (useC) count = MIN(count, independent(cpt));
+            }
+
+            // Fetch A, B, and C (disabled channels keep their old values)
+            if (useA) {
+                loadWordsSSE(a, block(apt, count), count, desc);
+                INC_CHIP_PTR_BY(apt, incr * count);
+            } else {
+                for (long i = 0; i < count; i++) a[i] = anew;
+            }
+            if (useB) {
+                loadWordsSSE(b, block(bpt, count), count, desc);
+                INC_CHIP_PTR_BY(bpt, incr * count);
+            } else {
+                for (long i = 0; i < count; i++) b[i] = bnew;
+            }
+            if (useC) {
+                loadWordsSSE(c, block(cpt, count), count, desc);
+                INC_CHIP_PTR_BY(cpt, incr * count);
+            } else {
+                for (long i = 0; i < count; i++) c[i] = chold;
+            }
+            anew = a[count - 1];
+            bnew = b[count - 1];
+            chold = c[count - 1];
+
+            // Apply the first and last word masks
+            if (x == 0) a[0] &= bltafwm;
+            if (x + count == bltsizeW) a[count - 1] &= bltalwm;
+
+            // Run the barrel shifters and the minterm logic circuit
+            a[-1] = aold;
+            b[-1] = bold;
+            uint16_t result = blitWordsSSE(d, a, b, c, count, ash, bsh, desc, minterm);
+
+            if (desc) {
+                ahold = HI_W_LO_W(a[count - 1], a[count - 2]) >> ash;
+                bhold = HI_W_LO_W(b[count - 1], b[count - 2]) >> bsh;
+            } else {
+                ahold = HI_W_LO_W(a[count - 2], a[count - 1]) >> ash;
+                bhold = HI_W_LO_W(b[count - 2], b[count - 1]) >> bsh;
+            }
+            aold = a[count - 1];
+            bold = b[count - 1];
+
+            // Run the fill logic circuit
+            if (fill) result = fillWordsSSE(d, count, bltconEFE(), fillCarry);
+            dhold = d[count - 1];
+
+            // Update the zero flag
+            if (result) bzero = false;
+
+            // Write D
+            if (useD) {
+                uint8_t *dst = block(dpt, count);
+                storeWordsSSE(dst, d, count, desc);
+                copper.didWriteChip((uint32_t)(dst - mem.chip), 2 * count);
+#ifndef NDEBUG
+                for (long i = 0; i < count; i++) {
+                    check1 = fnv_1a_it32(check1, d[i]);
+                    check2 = fnv_1a_it32(check2, CHIP_PTR(dpt + incr * i));
+                }
+#endif
+                INC_CHIP_PTR_BY(dpt, incr * count);
+            }
+        }
+
+        // Add modulo values
+        if (useA) INC_CHIP_PTR_BY(apt, amod);
+        if (useB) INC_CHIP_PTR_BY(bpt, bmod);
+        if (useC) INC_CHIP_PTR_BY(cpt, cmod);
+        if (useD) INC_CHIP_PTR_BY(dpt, dmod);
+    }
+
+    // Put the most recently fetched word on the data bus
+    if (useC) mem.dataBus = chold;
+    else if (useB) mem.dataBus = bnew;
+    else if (useA) mem.dataBus = anew;
+
+#else
+
     for (int y = 0; y < bltsizeH; y++) {
 
         // Reset the fill carry bit
@@ -191,6 +316,8 @@ void Blitter::doFastCopyBlit()
         if (useD) INC_CHIP_PTR_BY(dpt, dmod);
     }
 
+#endif
+
     // Do some consistency checks
     /*
     assert(apt == useA ? bltapt + (incr * bltsizeW + amod) * bltsizeH : bltapt);
@@ -206,30 +333,6 @@ void Blitter::doFastCopyBlit()
     bltdpt = dpt;
 }
 
-#define blitterLineIncreaseX(a_shift, cpt) \
-if (a_shift < 15) a_shift++; \
-else \
-{ \
-a_shift = 0; \
-INC_CHIP_PTR_BY(cpt, 2); \
-}
-
-#define blitterLineDecreaseX(a_shift, cpt) \
-{ \
-if (a_shift == 0) \
-{ \
-a_shift = 16; \
-INC_CHIP_PTR_BY(cpt, -2); \
-} \
-a_shift--; \
-}
-
-#define blitterLineIncreaseY(cpt, cmod) \
-INC_CHIP_PTR_BY(cpt, cmod);
-
-#define blitterLineDecreaseY(cpt, cmod) \
-INC_CHIP_PTR_BY(cpt, -cmod);
-
 void
 Blitter::doFastLineBlit()
 {
@@ -257,51 +360,160 @@ Blitter::doFastLineBlit()
     int16_t decision_inc_signed = a_enabled ? bltbmod : 0;
     int16_t decision_inc_unsigned = a_enabled ? bltamod : 0;
     
-    uint32_t bltcpt_local = bltcpt;
-    uint32_t bltdpt_local = bltdpt;
+    uint32_t bltcpt_local = CHIP_PTR(bltcpt);
+    uint32_t bltdpt_local = CHIP_PTR(bltdpt);
     uint32_t blit_a_shift_local = bltconASH();
     uint32_t bltzero_local = 0;
-    uint32_t i;
     
     uint32_t sulsudaul = (bltcon >> 2) & 0x7;
     bool x_independent = (sulsudaul & 4);
     bool x_inc = ((!x_independent) && !(sulsudaul & 2)) || (x_independent && !(sulsudaul & 1));
     bool y_inc = ((!x_independent) && !(sulsudaul & 1)) || (x_independent && !(sulsudaul & 2));
+    bool one_dot = x_independent && (bltcon & 0x00000002);
     bool single_dot = false;
     uint8_t minterm = (uint8_t)(bltcon >> 16);
-    
-    for (i = 0; i < height; ++i)
+
+    /* B is either all zeroes or all ones. Hence, the minterm reduces to a
+     * selection between four masks, indexed by [B][A][C].
+     */
+    uint16_t select[2][2][2];
+    for (int j = 0; j < 8; j++) {
+        select[(j >> 1) & 1][j >> 2][j & 1] = (minterm & (1 << j)) ? 0xFFFF : 0;
+    }
+
+    /* The pixel position moves one step along the major axis in each
+     * iteration and one step along the minor axis whenever the decision
+     * variable is not negative. For most slopes, the sign of the decision
+     * variable changes in an irregular pattern. Hence, both movements are
+     * computed arithmetically instead of branching on the sign.
+     */
+    int x_step = x_inc ? 1 : -1;
+    int32_t y_step = y_inc ? bltcmod : -bltcmod;
+    uint8_t *chip = mem.chip;
+
+    /* Lines with a horizontal major axis mostly draw several pixels into the
+     * same word before the line moves to the next word or row. In the common
+     * case, each of these pixels only modifies its own bit:
+     *
+     *     - A holds a single bit (it is shifted to the pixel position),
+     *     - C and D point to the same word,
+     *     - the minterm passes C through wherever A is 0.
+     *
+     * In this case, all pixels of a run are merged into the word with a
+     * single read and a single write. The decision variable, the B pattern,
+     * and the single-dot flag are still updated per pixel. Runs of a single
+     * pixel are cheaper to draw one by one. Hence, spans are only used if the
+     * line moves along the minor axis at most every second pixel, i.e., if
+     * 2 * sdelta <= ldelta (bltamod + bltbmod <= 0).
+     */
+    bool spans =
+    x_independent && c_enabled && (anew & bltafwm) == 0x8000 &&
+    decision_inc_signed + decision_inc_unsigned <= 0 &&
+    bltcpt_local == bltdpt_local &&
+    select[0][0][1] == 0xFFFF && select[0][0][0] == 0 &&
+    select[1][0][1] == 0xFFFF && select[1][0][0] == 0;
+
+    for (int i = 0; spans && i < height;)
+    {
+        uint32_t pt = bltcpt_local;
+        uint16_t c = READ_16(chip + pt);
+
+        // Compute the new value of each bit if a pixel is drawn on it
+        uint16_t g1 = (c & select[1][1][1]) | (~c & select[1][1][0]);
+        uint16_t g0 = (c & select[0][1][1]) | (~c & select[0][1][0]);
+
+        // Returns the bit drawn by the next pixel
+        auto nextPixel = [&]() {
+            uint16_t pixel = 0x8000 >> blit_a_shift_local;
+            if (one_dot) {
+                if (single_dot) pixel = 0;
+                single_dot = true;
+            }
+            return pixel;
+        };
+
+        // Collect the pixels of this run and the B pattern bits they see
+        uint16_t pixel = nextPixel(), firstPixel = pixel;
+        uint16_t pixels = 0, pattern = 0;
+        bool minor;
+
+        for (;; pixel = nextPixel()) {
+
+            pixels |= pixel;
+            bltbdat_local = (mask & 1) ? 0xFFFF : 0;
+            pattern |= pixel & bltbdat_local;
+            mask = (mask << 1) | (mask >> 15);
+
+#ifndef NDEBUG
+            uint16_t d = (c & ~pixels) | (g1 & pixels & pattern) | (g0 & pixels & ~pattern);
+            check1 = fnv_1a_it32(check1, d);
+            check2 = fnv_1a_it32(check2, pt);
+#endif
+
+            // Update the decision variable
+            minor = !decision_is_signed;
+            decision_variable += minor ? decision_inc_unsigned : decision_inc_signed;
+            decision_is_signed = ((int16_t)decision_variable < 0);
+            single_dot &= !minor;
+
+            // The run ends if the line leaves the word or the row
+            blit_a_shift_local += x_step;
+            if (++i == height || minor || (blit_a_shift_local & ~0xF)) break;
+        }
+
+        // Write the word back
+        bltddat_local = (c & ~pixels) | (g1 & pixels & pattern) | (g0 & pixels & ~pattern);
+        WRITE_16(chip + pt, bltddat_local);
+        copper.didWriteChip(pt);
+
+        /* Each pixel has read the word written by its predecessor. The words
+         * written before the last one additionally contain the original
+         * values of the bits drawn later. The first write only lacks the
+         * original value of the first pixel.
+         */
+        bltcdat_local = (bltddat_local & ~pixel) | (c & pixel);
+        bltzero_local |= bltddat_local | (c & ~firstPixel);
+
+        // Move to the next word
+        INC_CHIP_PTR_BY(bltcpt_local, 2 * ((int32_t)blit_a_shift_local >> 4) + (minor ? y_step : 0));
+        blit_a_shift_local &= 0xF;
+        bltdpt_local = bltcpt_local;
+    }
+
+    for (int i = 0; !spans && i < height; ++i)
     {
         // Read C-data from memory if the C-channel is enabled
         if (c_enabled) {
-            bltcdat_local = mem.peek16<BUS_BLITTER>(bltcpt_local);
+            bltcdat_local = READ_16(chip + bltcpt_local);
         }
         
         // Calculate data for the A-channel
         bltadat_local = (anew & bltafwm) >> blit_a_shift_local;
         
         // Check for single dot
-        if (x_independent) {
-            if (bltcon & 0x00000002) {
-                if (single_dot) {
-                    bltadat_local = 0;
-                } else {
-                    single_dot = TRUE;
-                }
-            }
+        if (one_dot) {
+            if (single_dot) bltadat_local = 0;
+            single_dot = true;
         }
         
         // Calculate data for the B-channel
         bltbdat_local = (mask & 1) ? 0xFFFF : 0;
         
         // Calculate result
-        bltddat_local = doMintermLogicQuick(bltadat_local, bltbdat_local, bltcdat_local, minterm);
+        uint16_t (*m)[2] = select[mask & 1];
+        bltddat_local =
+        (bltadat_local & ((bltcdat_local & m[1][1]) | (~bltcdat_local & m[1][0]))) |
+        (~bltadat_local & ((bltcdat_local & m[0][1]) | (~bltcdat_local & m[0][0])));
+        assert(bltddat_local == doMintermLogicQuick(bltadat_local, bltbdat_local, bltcdat_local, minterm));
         
         // Save result to D-channel, same as the C ptr after first pixel.
         if (c_enabled) { // C-channel must be enabled
-            mem.poke16<BUS_BLITTER>(bltdpt_local, bltddat_local);
+            WRITE_16(chip + bltdpt_local, bltddat_local);
+            copper.didWriteChip(bltdpt_local);
+#ifndef NDEBUG
             check1 = fnv_1a_it32(check1, bltddat_local);
             check2 = fnv_1a_it32(check2, bltdpt_local);
+#endif
         }
         
         // Remember zero result status
@@ -310,65 +522,38 @@ Blitter::doFastLineBlit()
         // Rotate mask
         mask = (mask << 1) | (mask >> 15);
         
-        // Test movement in the X direction
-        // When the decision variable gets positive,
-        // the line moves one pixel to the right
-        
-        // decrease/increase x
-        if (decision_is_signed) {
-            // Do not yet increase, D has sign
-            // D = D + (2*sdelta = bltbmod)
-            decision_variable += decision_inc_signed;
-        } else {
-            // increase, D reached a positive value
-            // D = D + (2*sdelta - 2*ldelta = bltamod)
-            decision_variable += decision_inc_unsigned;
-            
-            if (!x_independent) {
-                if (x_inc) {
-                    blitterLineIncreaseX(blit_a_shift_local, bltcpt_local);
-                } else {
-                    blitterLineDecreaseX(blit_a_shift_local, bltcpt_local);
-                }
-            } else {
-                if (y_inc) {
-                    blitterLineIncreaseY(bltcpt_local, bltcmod);
-                } else {
-                    blitterLineDecreaseY(bltcpt_local, bltcmod);
-                }
-                single_dot = false;
-            }
-        }
+        // Update the decision variable (D += 2*sdelta or D += 2*sdelta - 2*ldelta)
+        bool minor = !decision_is_signed;
+        decision_variable += minor ? decision_inc_unsigned : decision_inc_signed;
         decision_is_signed = ((int16_t)decision_variable < 0);
-        
-        if (!x_independent)
-        {
-            // decrease/increase y
-            if (y_inc) {
-                blitterLineIncreaseY(bltcpt_local, bltcmod);
-            } else {
-                blitterLineDecreaseY(bltcpt_local, bltcmod);
-            }
-        }
-        else
-        {
-            if (x_inc) {
-                blitterLineIncreaseX(blit_a_shift_local, bltcpt_local);
-            } else {
-                blitterLineDecreaseX(blit_a_shift_local, bltcpt_local);
-            }
+
+        // Move the pixel position
+        int x_move, y_move;
+        if (x_independent) {
+            x_move = x_step;
+            y_move = minor ? y_step : 0;
+            single_dot &= !minor;
+        } else {
+            x_move = minor ? x_step : 0;
+            y_move = y_step;
         }
+        blit_a_shift_local += x_move;
+        INC_CHIP_PTR_BY(bltcpt_local, 2 * ((int32_t)blit_a_shift_local >> 4) + y_move);
+        blit_a_shift_local &= 0xF;
         bltdpt_local = bltcpt_local;
     }
     bltcon = bltcon & 0x0FFFFFFBF;
     if (decision_is_signed) bltcon |= 0x00000040;
+
+    // Put the most recently fetched word on the data bus
+    if (c_enabled) mem.dataBus = bltcdat_local;
     
     setBltconASH(blit_a_shift_local);
     bnew   = bltbdat_local;
     bltapt = CHIP_PTR(decision_variable);
     bltcpt = CHIP_PTR(bltcpt_local);
     bltdpt = CHIP_PTR(bltdpt_local);
-    bzero  = bltzero_local;
+    if (bltzero_local) bzero = false;
 }
     /*
      void blitterLineMode(void)
@@ -68,7 +68,7 @@ public:
     TOD(CIA *cia, Amiga& ref);
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
     }
 
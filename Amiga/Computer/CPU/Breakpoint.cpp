@@ -124,7 +124,7 @@ private:
 #define PARSE_PREPARE \
 ASTNode *left = NULL, *right = NULL; \
 int oldi = i; \
-if (tokens.size() <= i) { return NULL; } \
+if ((int)tokens.size() <= i) { return NULL; } \
 
 #define SYNTAX_ERROR \
 { \
@@ -245,6 +245,7 @@ ASTNode::eval() {
             
         default:
             assert(false);
+            return 0;
     }
 }
 
@@ -20,7 +20,7 @@ BreakpointManager::BreakpointManager(Amiga &ref) : SubComponent(ref)
 Breakpoint *
 BreakpointManager::breakpointWithNr(long nr)
 {
-    if ((unsigned long)nr < numBreakpoints) {
+    if (nr >= 0 && nr < numBreakpoints) {
         assert(breakpoints[nr] != NULL);
         return breakpoints[nr];
     }
@@ -53,8 +53,8 @@ private:
 
     void _reset() override { }
     size_t _size() override { return 0; }
-    size_t _load(uint8_t *buffer) override { return 0; }
-    size_t _save(uint8_t *buffer) override { return 0; }
+    size_t _load(uint8_t *) override { return 0; }
+    size_t _save(uint8_t *) override { return 0; }
 
     
     //
@@ -12,8 +12,15 @@ extern "C" {
 #include "m68k.h"
 }
 
-// Reference to the active Amiga instance
-Amiga *activeAmiga = NULL;
+// Reference to the Amiga instance the calling thread is bound to
+thread_local Amiga *activeAmiga = NULL;
+
+// Builds the opcode tables of the CPU core and the disassembler
+static void initMusashiTables()
+{
+    m68k_init();
+    m68k_is_valid_instruction(0, M68K_CPU_TYPE_68000);
+}
 
 extern "C" unsigned int m68k_read_memory_8(unsigned int addr)
 {
@@ -33,6 +40,36 @@ extern "C" unsigned int m68k_read_memory_32(unsigned int addr)
     return activeAmiga->mem.peek32(addr);
 }
 
+extern "C" unsigned int m68k_read_immediate_16(unsigned int addr)
+{
+    assert(activeAmiga != NULL);
+    return activeAmiga->mem.fetch16(addr);
+}
+
+extern "C" unsigned int m68k_read_immediate_32(unsigned int addr)
+{
+    assert(activeAmiga != NULL);
+    return activeAmiga->mem.fetch32(addr);
+}
+
+extern "C" unsigned int m68k_read_pcrelative_8(unsigned int addr)
+{
+    assert(activeAmiga != NULL);
+    return activeAmiga->mem.fetch8(addr);
+}
+
+extern "C" unsigned int m68k_read_pcrelative_16(unsigned int addr)
+{
+    assert(activeAmiga != NULL);
+    return activeAmiga->mem.fetch16(addr);
+}
+
+extern "C" unsigned int m68k_read_pcrelative_32(unsigned int addr)
+{
+    assert(activeAmiga != NULL);
+    return activeAmiga->mem.fetch32(addr);
+}
+
 extern "C" unsigned int m68k_read_disassembler_16 (unsigned int addr)
 {
     assert(activeAmiga != NULL);
@@ -76,13 +113,11 @@ extern "C" uint32_t read_on_reset(uint32_t defaultValue)
     // Check for attached memory
     if (activeAmiga && activeAmiga->mem.chip) {
 
-        Memory *mem = &activeAmiga->mem;
-
         /* When we reach here, we expect memory to be initialised already.
          * If that's the case, the first memory page is mapped to Rom.
          */
-        assert(mem->memSrc[0x0] == MEM_ROM ||
-               mem->memSrc[0x0] == MEM_EXT);
+        assert(activeAmiga->mem.memSrc[0x0] == MEM_ROM ||
+               activeAmiga->mem.memSrc[0x0] == MEM_EXT);
 
         result = activeAmiga->mem.spypeek32(ADDRESS_68K(REG_PC));
     }
@@ -109,6 +144,7 @@ CPU::CPU(Amiga& ref) : SubComponent(ref)
     };
 
     config.shift = 2;
+    config.batch = true;
 }
 
 CPU::~CPU()
@@ -121,7 +157,12 @@ CPU::_initialize()
 {
     debug(CPU_DEBUG, "CPU::_initialize()\n");
 
+    // Build the opcode tables (only done once, shared by all instances)
+    static pthread_once_t tablesInitialized = PTHREAD_ONCE_INIT;
+    pthread_once(&tablesInitialized, initMusashiTables);
+
     // Initialize the Musashi CPU core
+    makeActiveInstance();
     m68k_init();
     m68k_set_cpu_type(M68K_CPU_TYPE_68000);
     m68k_set_int_ack_callback(interrupt_handler);
@@ -136,24 +177,6 @@ CPU::_powerOn()
     makeActiveInstance();
 }
 
-void
-CPU::_powerOff()
-{
-    if (activeAmiga == &amiga) {
-        debug("Stop being the active emulator instance\n");
-        activeAmiga = NULL;
-    }
-}
-
-void
-CPU::_run()
-{
-    debug(CPU_DEBUG, "CPU::_run()\n");
-
-    // Grab the Musashi core
-    makeActiveInstance();
-}
-
 void
 CPU::_reset()
 {
@@ -167,7 +190,7 @@ CPU::_reset()
 
     // Reset the Musashi CPU core
 #ifdef HARD_RESET
-    memset(&m68ki_cpu, 0, sizeof(m68ki_cpu));
+    memset(&core, 0, sizeof(core));
     m68k_init();
     m68k_set_cpu_type(M68K_CPU_TYPE_68000);
     m68k_set_int_ack_callback(interrupt_handler);
@@ -185,6 +208,9 @@ CPU::_inspect()
 {
     // Prevent external access to variable 'info'
     pthread_mutex_lock(&lock);
+
+    // Grab the Musashi core
+    makeActiveInstance();
     
     uint32_t pc = getPC();
     
@@ -264,6 +290,7 @@ CPU::_dump()
 void
 CPU::_dumpMusashi()
 {
+    makeActiveInstance();
     plainmsg("Musashi CPU:\n\n");
 
     plainmsg("                  cpu_type : %d\n", m68ki_cpu.cpu_type);
@@ -365,7 +392,7 @@ CPU::_size()
     applyToPersistentItems(counter);
     applyToResetItems(counter);
 
-    counter.count += m68k_context_size();
+    counter.count += sizeof(core);
 
     return counter.count;
 }
@@ -375,9 +402,7 @@ CPU::didLoadFromBuffer(uint8_t *buffer)
 {
     SerReader reader(buffer);
 
-    uint8_t context[m68k_context_size()];
-    reader.copy(context, m68k_context_size());
-    m68k_set_context(context);
+    reader.copy(&core, sizeof(core));
 
     debug(SNAP_DEBUG, "CPU state checksum: %x (%d bytes)\n",
           fnv_1a_64(buffer, reader.ptr - buffer), reader.ptr - buffer);
@@ -390,9 +415,7 @@ CPU::didSaveToBuffer(uint8_t *buffer) const
 {
     SerWriter writer(buffer);
 
-    uint8_t context[m68k_context_size()];
-    m68k_get_context(context);
-    writer.copy(context, m68k_context_size());
+    writer.copy(&core, sizeof(core));
 
     debug(SNAP_DEBUG, "CPU state checksum: %x (%d bytes)\n",
           fnv_1a_64(buffer, writer.ptr - buffer), writer.ptr - buffer);
@@ -425,85 +448,43 @@ CPU::setSpeed(int factor)
     assert(false);
 }
 
-void
-CPU::recordContext()
-{
-    debug(CPU_DEBUG, "recordContext: context = %p\n", context);
-    assert(context == NULL);
-    
-    // Allocate memory
-    context = new (std::nothrow) uint8_t[m68k_context_size()];
-    
-    // Save the current CPU context
-    if (context) m68k_get_context(context);
-}
-
-void
-CPU::restoreContext()
-{
-    debug(CPU_DEBUG, "restoreContext: context = %p\n", context);
-    if (context) {
-        
-        // Load the recorded context into the CPU
-        m68k_set_context(context);
-        
-        // Delete the recorded context
-        delete[] context;
-        context = NULL;
-    }
-}
-
 void
 CPU::makeActiveInstance()
 {
-    // Return immediately if this emulator instance is the active instance
-    if (activeAmiga == &amiga) return;
-
-    /* Pause the currently active emulator instance (if any)
-     * Because we're going to use the CPU core, we need to save the active
-     * instance's CPU context. It will be restored when the other instance
-     * becomes the active again (by calling this function).
-     */
-    if (activeAmiga != NULL) {
-        activeAmiga->pause();
-        activeAmiga->cpu.recordContext();
-    }
-
-    // Restore the previously recorded CPU state (if any)
-    restoreContext();
-
-    // Bind the CPU core to this emulator instance
+    m68k_bind_context(&core);
     activeAmiga = &amiga;
 }
 
 uint32_t
 CPU::getPC() const
 {
-    return m68k_get_reg(NULL, M68K_REG_PC);
+    return m68k_get_reg((void *)&core, M68K_REG_PC);
 }
 
 void
 CPU::setPC(uint32_t value)
 {
+    makeActiveInstance();
     m68k_set_reg(M68K_REG_PC, value);
 }
 
 uint32_t
 CPU::getSP()
 {
-    return m68k_get_reg(NULL, M68K_REG_SP);
+    return m68k_get_reg(&core, M68K_REG_SP);
 }
 
 uint32_t
 CPU::getIR()
 {
-    return m68k_get_reg(NULL, M68K_REG_IR);
+    return m68k_get_reg(&core, M68K_REG_IR);
 }
 
 uint32_t
 CPU::lengthOfInstruction(uint32_t addr)
 {
     char tmp[128];
+    makeActiveInstance();
     return m68k_disassemble(tmp, addr, M68K_CPU_TYPE_68000);
 }
 
@@ -514,6 +495,7 @@ CPU::disassemble(uint32_t addr)
     
     if (addr <= 0xFFFFFF) {
         
+        makeActiveInstance();
         result.bytes = m68k_disassemble(result.instr, addr, M68K_CPU_TYPE_68000);
         mem.hex(result.data, addr, result.bytes, sizeof(result.data));
         sprint24x(result.addr, addr);
@@ -574,7 +556,7 @@ CPU::recordInstruction()
     instr.sp = getSP();
 
     // Store record
-    assert(writePtr < traceBufferCapacity);
+    assert(writePtr < (int)traceBufferCapacity);
     traceBuffer[writePtr] = instr;
 
     // Advance write pointer
@@ -608,6 +590,52 @@ CPU::executeInstruction()
     return clock;
 }
 
+Cycle
+CPU::executeInstructions(Cycle eventClock)
+{
+    // The IRQ level pipeline is clocked per instruction
+    if (actions) return executeInstruction();
+
+    /* Agnus serves the pending event once it advances past the DMA cycle
+     * the event is scheduled in. Every instruction that starts before this
+     * point in time would also have been executed by single-stepping.
+     */
+    Cycle limit = MIN(eventClock, clock + DMA_CYCLES(HPOS_CNT));
+    limit = (limit & ~0b111) + DMA_CYCLES(1);
+    CPUCycle budget = (limit - clock + (1 << config.shift) - 1) >> config.shift;
+
+    batching = true;
+    batchCycles = 0;
+    CPUCycle cycles = m68k_execute((int)MAX(budget, 1));
+    batching = false;
+
+    // Skip the cycles endBatch() has already added
+    advance(cycles - batchCycles);
+
+    if (waitStates) debug(CPU_DEBUG, "Adding %d wait states\n", waitStates);
+    clock += waitStates;
+    waitStates = 0;
+
+    return clock;
+}
+
+void
+CPU::endBatch()
+{
+    assert(batching);
+    batching = false;
+
+    // Advance the clock to the beginning of the current instruction
+    batchCycles = m68k_instr_cycles_run();
+    advance(batchCycles);
+
+    // Emulate Agnus up to the same cycle
+    agnus.executeUntil(clock);
+
+    // Let m68k_execute() return after the current instruction
+    m68k_modify_timeslice(-m68k_cycles_remaining());
+}
+
 void
 CPU::setIrqLevel(int level)
 {
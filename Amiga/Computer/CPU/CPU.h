@@ -30,6 +30,13 @@
  *  The change was necessary, because m68ki_read_imm_32() invokes vAmiga's
  *  standard Memory::peek32() function which requires the emulator to be
  *  running.
+ *
+ * - In function int m68k_execute(int num_cycles):
+ *
+ *       The number of remaining cycles is recorded in variable
+ *       m68ki_instr_start_cycles before an instruction is executed. It is
+ *       queried via m68k_instr_cycles_run() when the CPU runs ahead of Agnus
+ *       and Agnus needs to catch up with the beginning of the instruction.
  */
 
 extern "C" {
@@ -69,6 +76,12 @@ private:
     // The new interrupt level
     int irqLevel;
 
+    // Indicates if the CPU is running ahead of Agnus
+    bool batching = false;
+
+    // CPU cycles of the current batch that have already been added to clock
+    CPUCycle batchCycles = 0;
+
 public: // REMOVE
     
     // Additional delay in master cycles if the CPU can't access the bus
@@ -76,17 +89,17 @@ public: // REMOVE
 
 
     //
-    // CPU state switching
+    // Musashi state
     //
     
 private:
     
-    /* CPU context
-     * This variable is usually NULL. When the user switches to another
-     * emulator instance, it is used to store the current context. When the
-     * user switches back, the previously saved state is restored.
+    /* Register file of this CPU
+     * Musashi operates on the context that is bound to the calling thread.
+     * Each emulator instance owns its own context which is bound by calling
+     * makeActiveInstance() before the core is accessed.
      */
-    uint8_t *context = NULL;
+    m68ki_cpu_core core = { };
 
 
     //
@@ -116,7 +129,7 @@ public:
     ~CPU();
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
     }
 
@@ -143,6 +156,9 @@ public:
     int getSpeed();
     void setSpeed(int factor);
 
+    // Enables or disables batch execution (see executeInstructions())
+    void setBatch(bool value) { config.batch = value; }
+
 
     //
     // Methods from HardwareComponent
@@ -152,8 +168,6 @@ private:
 
     void _initialize() override;
     void _powerOn() override;
-    void _powerOff() override; 
-    void _run() override;
     void _reset() override;
     void _inspect() override;
     void _dumpConfig() override;
@@ -174,30 +188,17 @@ public:
 
 
     //
-    // Recording and restoring the CPU context
+    // Binding the Musashi core
     //
     
 public:
     
-    // Returns true if a CPU context has been saved previously
-    bool hasSavedContext() { return context != NULL; }
-    
-    // Records the current CPU context
-    void recordContext();
-    
-    // Restores the current CPU context
-    void restoreContext();
-
-    /* Assign the Musashi core to this CPU.
-     * Background: Because we only have one CPU core available, we need to
-     * share this core among all emulator instances. This means that only one
-     * emulator instance can run at a time and the other instances need to
-     * be powered off or paused. When an emulator instance needs to acces the
-     * CPU core, it has to make itself the 'active emulator instance' by
-     * calling this function. It will bind the CPU to this emulator instance
-     * by rerouting all memory accesses to this instance.
-     * If another instance is currently active, it is put into pause mode
-     * automatically.
+    /* Binds the Musashi core to this CPU.
+     * Musashi keeps a thread-local reference to the context it operates on.
+     * This function makes the calling thread operate on this CPU's context
+     * and routes all memory accesses to this emulator instance. It has to be
+     * called by every thread before accessing the CPU core. Because the
+     * binding is per thread, multiple emulator instances can run in parallel.
      */
     void makeActiveInstance();
 
@@ -283,6 +284,23 @@ public:
     // Executes the next instruction and returns the new CPU clock value
     Cycle executeInstruction();
 
+    /* Executes multiple instructions without synchronizing Agnus.
+     * The CPU runs ahead until Agnus needs to process the event scheduled
+     * for the provided cycle or until the chip bus is accessed, whatever
+     * comes first. Returns the new CPU clock value.
+     */
+    Cycle executeInstructions(Cycle eventClock);
+
+    // Indicates if the CPU is running ahead of Agnus
+    bool isBatching() { return batching; }
+
+    /* Synchronizes Agnus with a CPU that is running ahead.
+     * The CPU clock is advanced to the beginning of the current instruction,
+     * Agnus is emulated up to the same cycle, and the running batch is
+     * terminated after this instruction.
+     */
+    void endBatch();
+
     // Changes the interrupt level
     void setIrqLevel(int level);
 
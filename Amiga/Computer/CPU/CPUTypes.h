@@ -67,6 +67,9 @@ typedef struct
 {
     // Number of applied bit shifts to convert CPU cycles into master cycles
     int shift;
+
+    // Indicates if multiple instructions are executed per Agnus sync
+    bool batch;
 }
 CPUConfig;
 
@@ -320,6 +320,7 @@ int m68k_execute(int num_cycles);
  * that requires immediate processing by another CPU.
  */
 int m68k_cycles_run(void);              /* Number of cycles run so far */
+int m68k_instr_cycles_run(void);        /* Number of cycles run before the current instruction */
 int m68k_cycles_remaining(void);        /* Number of cycles left */
 void m68k_modify_timeslice(int cycles); /* Modify cycles left */
 void m68k_end_timeslice(void);          /* End timeslice now */
@@ -352,6 +353,12 @@ unsigned int m68k_get_context(void* dst);
 /* set the current cpu context */
 void m68k_set_context(void* dst);
 
+/* Make the calling thread operate on the provided context in place. The
+ * context must be at least m68k_context_size() bytes large and must outlive
+ * the binding. Passing NULL binds the thread to the built-in context.
+ */
+void m68k_bind_context(void* context);
+
 /* Register the CPU state information */
 void m68k_state_register(const char *type, int index);
 
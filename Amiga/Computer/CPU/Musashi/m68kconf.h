@@ -74,7 +74,7 @@
  * and m68k_read_pcrelative_xx() for PC-relative addressing.
  * If off, all read requests from the CPU will be redirected to m68k_read_xx()
  */
-#define M68K_SEPARATE_READS         OPT_OFF
+#define M68K_SEPARATE_READS         OPT_ON
 
 /* If ON, the CPU will call m68k_write_32_pd() when it executes move.l with a
  * predecrement destination EA mode instead of m68k_write_32().
@@ -207,6 +207,16 @@
 #define INLINE static inline
 #endif /* INLINE */
 
+
+/* Storage class of the core's mutable globals. vAmiga runs multiple emulator
+ * instances side by side. Each instance owns its CPU state and binds it to
+ * the calling thread via m68k_bind_context(). Hence, the pointer to the
+ * active context and the per-run bookkeeping variables must be thread-local.
+ */
+#ifndef M68K_THREAD_LOCAL
+#define M68K_THREAD_LOCAL __thread
+#endif /* M68K_THREAD_LOCAL */
+
 #endif /* M68K_COMPILE_FOR_MAME */
 
 
@@ -51,10 +51,11 @@ extern void m68ki_build_opcode_table(void);
 /* ================================= DATA ================================= */
 /* ======================================================================== */
 
-int  m68ki_initial_cycles;
-int  m68ki_remaining_cycles = 0;                     /* Number of clocks remaining */
-uint m68ki_tracing = 0;
-uint m68ki_address_space;
+M68K_THREAD_LOCAL int  m68ki_initial_cycles;
+M68K_THREAD_LOCAL int  m68ki_remaining_cycles = 0;   /* Number of clocks remaining */
+M68K_THREAD_LOCAL int  m68ki_instr_start_cycles;     /* Clocks remaining when the current instruction started */
+M68K_THREAD_LOCAL uint m68ki_tracing = 0;
+M68K_THREAD_LOCAL uint m68ki_address_space;
 
 #ifdef M68K_LOG_ENABLE
 const char *const m68ki_cpu_names[] =
@@ -71,16 +72,19 @@ const char *const m68ki_cpu_names[] =
 };
 #endif /* M68K_LOG_ENABLE */
 
-/* The CPU core */
-m68ki_cpu_core m68ki_cpu = {0};
+/* The CPU core. Used by threads that haven't bound a context of their own */
+static m68ki_cpu_core m68ki_default_cpu = {0};
+
+/* The CPU core the calling thread operates on */
+M68K_THREAD_LOCAL m68ki_cpu_core *m68ki_cpu_p = &m68ki_default_cpu;
 
 #if M68K_EMULATE_ADDRESS_ERROR
-jmp_buf m68ki_aerr_trap;
+M68K_THREAD_LOCAL jmp_buf m68ki_aerr_trap;
 #endif /* M68K_EMULATE_ADDRESS_ERROR */
 
-uint    m68ki_aerr_address;
-uint    m68ki_aerr_write_mode;
-uint    m68ki_aerr_fc;
+M68K_THREAD_LOCAL uint m68ki_aerr_address;
+M68K_THREAD_LOCAL uint m68ki_aerr_write_mode;
+M68K_THREAD_LOCAL uint m68ki_aerr_fc;
 
 /* Used by shift & rotate instructions */
 const uint8 m68ki_shift_8_table[65] =
@@ -517,7 +521,7 @@ static void default_instr_hook_callback(unsigned int pc)
 
 #if M68K_EMULATE_ADDRESS_ERROR
 	#include <setjmp.h>
-	jmp_buf m68ki_aerr_trap;
+	M68K_THREAD_LOCAL jmp_buf m68ki_aerr_trap;
 #endif /* M68K_EMULATE_ADDRESS_ERROR */
 
 
@@ -783,6 +787,7 @@ int m68k_execute(int num_cycles)
 	/* Set our pool of clock cycles available */
 	SET_CYCLES(num_cycles);
 	m68ki_initial_cycles = num_cycles;
+	m68ki_instr_start_cycles = num_cycles;
 
 	/* See if interrupts came in */
 	m68ki_check_interrupts();
@@ -807,6 +812,7 @@ int m68k_execute(int num_cycles)
 
 			/* Record previous program counter */
 			REG_PPC = REG_PC;
+			m68ki_instr_start_cycles = GET_CYCLES();
 
 			/* Read an instruction and call its handler */
 			REG_IR = m68ki_read_imm_16();
@@ -833,6 +839,11 @@ int m68k_cycles_run(void)
 	return m68ki_initial_cycles - GET_CYCLES();
 }
 
+int m68k_instr_cycles_run(void)
+{
+	return m68ki_initial_cycles - m68ki_instr_start_cycles;
+}
+
 int m68k_cycles_remaining(void)
 {
 	return GET_CYCLES();
@@ -980,6 +991,11 @@ void m68k_set_context(void* src)
 	if(src) m68ki_cpu = *(m68ki_cpu_core*)src;
 }
 
+void m68k_bind_context(void* context)
+{
+	m68ki_cpu_p = context ? (m68ki_cpu_core*)context : &m68ki_default_cpu;
+}
+
 
 
 /* ======================================================================== */
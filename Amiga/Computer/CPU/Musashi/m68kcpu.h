@@ -39,6 +39,7 @@ extern "C" {
 
 #include "m68k.h"
 #include <limits.h>
+#include <stdint.h>
 
 #if M68K_EMULATE_ADDRESS_ERROR
 #include <setjmp.h>
@@ -573,7 +574,7 @@ extern "C" {
 /* Address error */
 #if M68K_EMULATE_ADDRESS_ERROR
 	#include <setjmp.h>
-	extern jmp_buf m68ki_aerr_trap;
+	extern M68K_THREAD_LOCAL jmp_buf m68ki_aerr_trap;
 
 	#define m68ki_set_address_error_trap() \
 		if(setjmp(m68ki_aerr_trap) != 0) \
@@ -938,19 +939,21 @@ typedef struct
 } m68ki_cpu_core;
 
 
-extern m68ki_cpu_core m68ki_cpu;
-extern sint           m68ki_remaining_cycles;
-extern uint           m68ki_tracing;
+extern M68K_THREAD_LOCAL m68ki_cpu_core *m68ki_cpu_p;
+#define m68ki_cpu (*m68ki_cpu_p)
+
+extern M68K_THREAD_LOCAL sint m68ki_remaining_cycles;
+extern M68K_THREAD_LOCAL uint m68ki_tracing;
 extern const uint8    m68ki_shift_8_table[];
 extern const uint16   m68ki_shift_16_table[];
 extern const uint     m68ki_shift_32_table[];
 extern const uint8    m68ki_exception_cycle_table[][256];
-extern uint           m68ki_address_space;
+extern M68K_THREAD_LOCAL uint m68ki_address_space;
 extern const uint8    m68ki_ea_idx_cycle_table[];
 
-extern uint           m68ki_aerr_address;
-extern uint           m68ki_aerr_write_mode;
-extern uint           m68ki_aerr_fc;
+extern M68K_THREAD_LOCAL uint m68ki_aerr_address;
+extern M68K_THREAD_LOCAL uint m68ki_aerr_write_mode;
+extern M68K_THREAD_LOCAL uint m68ki_aerr_fc;
 
 /* Forward declarations to keep some of the macros happy */
 static inline uint m68ki_read_16_fc (uint address, uint fc);
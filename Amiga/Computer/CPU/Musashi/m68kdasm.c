@@ -203,16 +203,16 @@ static void (*g_instruction_table[0x10000])(void);
 static int  g_initialized = 0;
 
 /* Address mask to simulate address lines */
-static unsigned int g_address_mask = 0xffffffff;
+static M68K_THREAD_LOCAL unsigned int g_address_mask = 0xffffffff;
 
-static char g_dasm_str[100]; /* string to hold disassembly */
-static char g_helper_str[100]; /* string to hold helpful info */
-static uint g_cpu_pc;        /* program counter */
-static uint g_cpu_ir;        /* instruction register */
-static uint g_cpu_type;
-static uint g_opcode_type;
-static const unsigned char* g_rawop;
-static uint g_rawbasepc;
+static M68K_THREAD_LOCAL char g_dasm_str[100]; /* string to hold disassembly */
+static M68K_THREAD_LOCAL char g_helper_str[100]; /* string to hold helpful info */
+static M68K_THREAD_LOCAL uint g_cpu_pc;        /* program counter */
+static M68K_THREAD_LOCAL uint g_cpu_ir;        /* instruction register */
+static M68K_THREAD_LOCAL uint g_cpu_type;
+static M68K_THREAD_LOCAL uint g_opcode_type;
+static M68K_THREAD_LOCAL const unsigned char* g_rawop;
+static M68K_THREAD_LOCAL uint g_rawbasepc;
 
 /* used by ops like asr, ror, addq, etc */
 static const uint g_3bit_qdata_table[8] = {8, 1, 2, 3, 4, 5, 6, 7};
@@ -376,7 +376,7 @@ static char* make_signed_hex_str_32(uint val)
 /* make string of immediate value */
 static char* get_imm_str_s(uint size)
 {
-	static char str[15];
+	static char str[21];
 	if(size == 0)
 		sprintf(str, "#%s", make_signed_hex_str_8(read_imm_8()));
 	else if(size == 1)
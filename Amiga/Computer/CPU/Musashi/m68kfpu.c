@@ -1,6 +1,7 @@
 #include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "m68kcpu.h"
 
 extern void exit(int);
@@ -468,7 +469,9 @@ static void fpgen_rm_reg(uint16 w2)
 			case 1:		// Single-precision Real
 			{
 				uint32 d = READ_EA_32(ea);
-				source = (double)(*(float*)&d);
+				float f;
+				memcpy(&f, &d, sizeof(f));
+				source = (double)f;
 				break;
 			}
 			case 2:		// Extended-precision Real
@@ -490,7 +493,7 @@ static void fpgen_rm_reg(uint16 w2)
 			case 5:		// Double-precision Real
 			{
 				uint64 d = READ_EA_64(ea);
-				source = *(double*)&d;
+				memcpy(&source, &d, sizeof(source));
 				break;
 			}
 			case 6:		// Byte Integer
@@ -602,7 +605,8 @@ static void fmove_reg_mem(uint16 w2)
 		case 1:		// Single-precision Real
 		{
 			float f = (float)(REG_FP[src].f);
-			uint32 d = *(uint32 *)&f;
+			uint32 d;
+			memcpy(&d, &f, sizeof(d));
 			WRITE_EA_32(ea, d);
 			break;
 		}
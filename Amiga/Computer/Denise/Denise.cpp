@@ -8,6 +8,7 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "sse_utils.h"
 
 int dirk = 0;
 
@@ -451,11 +452,11 @@ void
 Denise::fillShiftRegisters()
 {
     switch (bpu()) {
-        case 6: shiftReg[5] = REPLACE_LO_WORD(shiftReg[5], bpldat[5]);
-        case 5: shiftReg[4] = REPLACE_LO_WORD(shiftReg[4], bpldat[4]);
-        case 4: shiftReg[3] = REPLACE_LO_WORD(shiftReg[3], bpldat[3]);
-        case 3: shiftReg[2] = REPLACE_LO_WORD(shiftReg[2], bpldat[2]);
-        case 2: shiftReg[1] = REPLACE_LO_WORD(shiftReg[1], bpldat[1]);
+        case 6: shiftReg[5] = REPLACE_LO_WORD(shiftReg[5], bpldat[5]); [[fallthrough]];
+        case 5: shiftReg[4] = REPLACE_LO_WORD(shiftReg[4], bpldat[4]); [[fallthrough]];
+        case 4: shiftReg[3] = REPLACE_LO_WORD(shiftReg[3], bpldat[3]); [[fallthrough]];
+        case 3: shiftReg[2] = REPLACE_LO_WORD(shiftReg[2], bpldat[2]); [[fallthrough]];
+        case 2: shiftReg[1] = REPLACE_LO_WORD(shiftReg[1], bpldat[1]); [[fallthrough]];
         case 1: shiftReg[0] = REPLACE_LO_WORD(shiftReg[0], bpldat[0]);
     }
 }
@@ -472,17 +473,51 @@ Denise::draw(int pixels)
         spriteClipBegin = currentPixel - 2;
     }
 
-    uint32_t maskOdd, maskEven;
+    int8_t scrollOdd = HIRES ? scrollHiresOdd : scrollLoresOdd;
+    int8_t scrollEven = HIRES ? scrollHiresEven : scrollLoresEven;
+    uint32_t maskOdd = 0x8000 << scrollOdd;
+    uint32_t maskEven = 0x8000 << scrollEven;
+    int i = 0;
 
-    if (HIRES) {
-        maskOdd = 0x8000 << scrollHiresOdd;
-        maskEven = 0x8000 << scrollHiresEven;
-    } else {
-        maskOdd = 0x8000 << scrollLoresOdd;
-        maskEven = 0x8000 << scrollLoresEven;
+#ifdef __SSSE3__
+
+    // Convert a complete 16 pixel chunk in one go
+    if (pixels >= 16) {
+
+        uint16_t slice[8] = {
+            (uint16_t)(shiftReg[0] >> scrollOdd),
+            (uint16_t)(shiftReg[1] >> scrollEven),
+            (uint16_t)(shiftReg[2] >> scrollOdd),
+            (uint16_t)(shiftReg[3] >> scrollEven),
+            (uint16_t)(shiftReg[4] >> scrollOdd),
+            (uint16_t)(shiftReg[5] >> scrollEven),
+            0,
+            0
+        };
+
+        if (HIRES) {
+
+            // Synthesize 16 hires pixels
+            assert(currentPixel + 15 < (int)sizeof(bBuffer));
+            transposeSSE(slice, bBuffer + currentPixel);
+            currentPixel += 16;
+
+        } else {
+
+            // Synthesize 32 lores pixels
+            assert(currentPixel + 31 < (int)sizeof(bBuffer));
+            transposeDoubleSSE(slice, bBuffer + currentPixel);
+            currentPixel += 32;
+        }
+
+        maskOdd >>= 16;
+        maskEven >>= 16;
+        i = 16;
     }
 
-    for (int i = 0; i < pixels; i++) {
+#endif
+
+    for (; i < pixels; i++) {
 
         // Read a bit slice
         index =
@@ -499,13 +534,13 @@ Denise::draw(int pixels)
         if (HIRES) {
 
             // Synthesize one hires pixel
-            assert(currentPixel < sizeof(bBuffer));
+            assert(currentPixel < (int)sizeof(bBuffer));
             bBuffer[currentPixel++] = index;
 
         } else {
 
             // Synthesize two lores pixels
-            assert(currentPixel + 1 < sizeof(bBuffer));
+            assert(currentPixel + 1 < (int)sizeof(bBuffer));
             bBuffer[currentPixel++] = index;
             bBuffer[currentPixel++] = index;
         }
@@ -783,8 +818,8 @@ Denise::drawSpritePair(int hstrt, int hstop,
                        uint16_t datb1, uint16_t datb2,
                        bool armed1, bool armed2, bool at)
 {
-    assert(hstrt >= 0 && hstrt <= sizeof(iBuffer));
-    assert(hstop >= 0 && hstop <= sizeof(iBuffer));
+    assert(hstrt >= 0 && hstrt <= (int)sizeof(iBuffer));
+    assert(hstop >= 0 && hstop <= (int)sizeof(iBuffer));
 
     for (int hpos = hstrt; hpos < hstop; hpos += 2) {
 
@@ -904,7 +939,7 @@ Denise::drawBorder()
         // Draw left border
         if (!agnus.diwHFlop && agnus.diwHFlopOn != -1) {
             for (int i = 0; i < 2 * agnus.diwHFlopOn; i++) {
-                assert(i < sizeof(iBuffer));
+                assert(i < (int)sizeof(iBuffer));
                 iBuffer[i] = borderL;
             }
         }
@@ -912,7 +947,7 @@ Denise::drawBorder()
         // Draw right border
         if (agnus.diwHFlopOff != -1) {
             for (int i = 2 * agnus.diwHFlopOff; i <= LAST_PIXEL; i++) {
-                assert(i < sizeof(iBuffer));
+                assert(i < (int)sizeof(iBuffer));
                 iBuffer[i] = borderR;
             }
         }
@@ -976,21 +1011,6 @@ Denise::checkS2PCollisions(int start, int end)
     // For the odd sprites, only proceed if collision detection is enabled
     if (IS_ODD(x) && !getENSP<x>()) return;
 
-    // Set up the sprite comparison mask
-    uint16_t sprMask;
-    switch(x) {
-        case 0:
-        case 1: sprMask = Z_SP0 | (getENSP<1>() ? Z_SP1 : 0); break;
-        case 2:
-        case 3: sprMask = Z_SP2 | (getENSP<3>() ? Z_SP3 : 0); break;
-        case 4:
-        case 5: sprMask = Z_SP4 | (getENSP<5>() ? Z_SP5 : 0); break;
-        case 6:
-        case 7: sprMask = Z_SP6 | (getENSP<7>() ? Z_SP7 : 0); break;
-
-        default: sprMask = 0; assert(false);
-    }
-
     uint8_t enabled1 = getENBP1();
     uint8_t enabled2 = getENBP2();
     uint8_t compare1 = getMVBP1() & enabled1;
@@ -1066,7 +1086,7 @@ Denise::beginOfFrame(bool interlace)
 }
 
 void
-Denise::beginOfLine(int vpos)
+Denise::beginOfLine(int )
 {
     // Reset the register history buffers
     conRegChanges.clear();
@@ -1131,7 +1151,7 @@ Denise::endOfLine(int vpos)
 }
 
 void
-Denise::pokeDMACON(uint16_t oldValue, uint16_t newValue)
+Denise::pokeDMACON(uint16_t , uint16_t newValue)
 {
     if (Agnus::doBplDMA(newValue)) {
 
@@ -1237,8 +1257,8 @@ Denise::dumpBuffer(uint8_t *buffer, size_t length)
 {
     const size_t cols = 16;
 
-    for (int i = 0; i < (length + cols - 1) / cols; i++) {
-        for (int j =0; j < cols; j++) plainmsg("%2d ", buffer[i * cols + j]);
+    for (size_t i = 0; i < (length + cols - 1) / cols; i++) {
+        for (size_t j = 0; j < cols; j++) plainmsg("%2d ", buffer[i * cols + j]);
         plainmsg("\n");
     }
 }
@@ -8,6 +8,7 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "sse_utils.h"
 
 PixelEngine::PixelEngine(Amiga& ref) : SubComponent(ref)
 {
@@ -26,7 +27,7 @@ PixelEngine::PixelEngine(Amiga& ref) : SubComponent(ref)
     // Create random background noise pattern
     const size_t noiseSize = 2 * 512 * 512;
     noise = new int[noiseSize];
-    for (int i = 0; i < noiseSize; i++) {
+    for (size_t i = 0; i < noiseSize; i++) {
         noise[i] = rand() % 2 ? 0x00000000 : 0x00FFFFFF;
     }
 
@@ -39,6 +40,18 @@ PixelEngine::PixelEngine(Amiga& ref) : SubComponent(ref)
     indexedRgba[69] = GpuColor(0x00, 0xD0, 0xD0).rawValue;
     indexedRgba[70] = GpuColor(0x00, 0xA0, 0xA0).rawValue;
     indexedRgba[71] = GpuColor(0x00, 0x90, 0x90).rawValue;
+
+    // Setup the HAM lookup tables (see colorizeHAM())
+    for (int i = 0; i < 64; i++) {
+
+        switch ((i >> 4) & 0b11) {
+
+            case 0b00: hamMask[i] = 0x000; hamBits[i] = 0; break;
+            case 0b01: hamMask[i] = 0xFF0; hamBits[i] = (i & 0xF); break;
+            case 0b10: hamMask[i] = 0x0FF; hamBits[i] = (i & 0xF) << 8; break;
+            case 0b11: hamMask[i] = 0xF0F; hamBits[i] = (i & 0xF) << 4; break;
+        }
+    }
     /*
     colors[64] = 0x0F00;
     colors[65] = 0x0D00;
@@ -403,47 +416,34 @@ PixelEngine::colorize(uint8_t *src, int line)
 void
 PixelEngine::colorize(uint8_t *src, int *dst, int from, int to)
 {
+    if (from >= to) return;
+
+#ifdef __SSSE3__
+    colorizeSSE(src + from, (uint32_t *)dst + from, indexedRgba, to - from);
+#else
     for (int i = from; i < to; i++) {
         dst[i] = indexedRgba[src[i]];
     }
+#endif
 }
 
 void
 PixelEngine::colorizeHAM(uint8_t *src, int *dst, int from, int to, uint16_t& ham)
 {
+    /* Each HAM pixel either replaces the hold register with the value of a
+     * color register or modifies a single color component. Both cases are
+     * expressed as ham = (ham & mask) | bits to avoid branching per pixel.
+     */
+    uint16_t bits[64];
+    memcpy(bits, hamBits, sizeof(bits));
+    memcpy(bits, colreg, 16 * sizeof(uint16_t));
+
     for (int i = from; i < to; i++) {
 
         uint8_t index = src[i];
         assert(isRgbaIndex(index));
 
-        switch ((index >> 4) & 0b11) {
-
-            case 0b00: // Get color from register
-
-                ham = colreg[index];
-                break;
-
-            case 0b01: // Modify blue
-
-                ham &= 0xFF0;
-                ham |= (index & 0b1111);
-                break;
-
-            case 0b10: // Modify red
-
-                ham &= 0x0FF;
-                ham |= (index & 0b1111) << 8;
-                break;
-
-            case 0b11: // Modify green
-
-                ham &= 0xF0F;
-                ham |= (index & 0b1111) << 4;
-                break;
-
-            default:
-                assert(false);
-        }
+        ham = (ham & hamMask[index & 0x3F]) | bits[index & 0x3F];
 
         // Synthesize pixel
         dst[i] = rgba[ham];
@@ -73,6 +73,14 @@ private:
     static const int rgbaIndexCnt = 32 + 32 + 8;
     uint32_t indexedRgba[rgbaIndexCnt];
 
+    /* HAM mode lookup tables
+     * A HAM pixel with index i changes the hold register to
+     * (hold & hamMask[i]) | hamBits[i]. For indices 0 .. 15, hamBits[i] is
+     * a placeholder which is replaced by the value of color register i.
+     */
+    uint16_t hamMask[64];
+    uint16_t hamBits[64];
+
     // Color adjustment parameters
     Palette palette = COLOR_PALETTE;
     double brightness = 50.0;
@@ -108,7 +116,7 @@ public:
     //
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
     }
 
@@ -64,7 +64,7 @@ ZorroManager::peekFastRamDevice(uint32_t addr)
      *              111 = 4 megabytes
      */
     uint8_t erTypeHi = 0b1110; // Zorro II, Free pool, Don't boot
-    uint8_t erTypeLo;
+    uint8_t erTypeLo = 0;
     
     switch (fastRamSize) {
         case KB(64):  erTypeLo = 0b001; break;
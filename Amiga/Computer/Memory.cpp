@@ -16,6 +16,10 @@ Memory::Memory(Amiga& ref) : SubComponent(ref)
 
     memset(&config, 0, sizeof(config));
     config.extStart = 0xE0;
+
+    memset(cpuPeekPtr, 0, sizeof(cpuPeekPtr));
+    memset(cpuPokePtr, 0, sizeof(cpuPokePtr));
+    memset(cpuPeekCnt, 0, sizeof(cpuPeekCnt));
 }
 
 Memory::~Memory()
@@ -162,6 +166,9 @@ Memory::didLoadFromBuffer(uint8_t *buffer)
     reader.copy(slow, config.slowSize);
     reader.copy(fast, config.fastSize);
 
+    // Rebuild the direct access tables, because memory has been reallocated
+    updateAccessTables();
+
     return reader.ptr - buffer;
 }
 
@@ -232,6 +239,8 @@ Memory::fillRamWithStartupPattern()
     if (chip) memset(chip, 0, config.chipSize);
     if (slow) memset(slow, 0, config.slowSize);
     if (fast) memset(fast, 0, config.fastSize);
+
+    copper.clearCache();
 }
 
 RomRevision
@@ -589,10 +598,10 @@ Memory::updateMemSrcTable()
     MemorySource mem_rom = rom ? MEM_ROM : MEM_UNMAPPED;
     MemorySource mem_wom = wom ? MEM_WOM : mem_rom;
 
-    int chipRamPages = hasChipRam() ? 32 : 0;
-    int slowRamPages = config.slowSize / 0x10000;
-    int fastRamPages = config.fastSize / 0x10000;
-    int extRomPages  = hasExt() ? 8 : 0;
+    unsigned chipRamPages = hasChipRam() ? 32 : 0;
+    unsigned slowRamPages = config.slowSize / 0x10000;
+    unsigned fastRamPages = config.fastSize / 0x10000;
+    unsigned extRomPages  = hasExt() ? 8 : 0;
 
     // Mirror Chip Ram if only a 256KB Rom is present
     if (chipRamPages == 4) chipRamPages = 8;
@@ -663,14 +672,104 @@ Memory::updateMemSrcTable()
             memSrc[i] = memSrc[0xF8 + i];
     }
 
+    updateAccessTables();
+
     amiga.putMessage(MSG_MEM_LAYOUT);
 }
 
+uint8_t *
+Memory::bankPtr(uint8_t *ptr, uint32_t mask, uint32_t offset)
+{
+    // Memory that is mirrored inside a bank can't be accessed directly
+    if (ptr == NULL || mask < 0xFFFF) return NULL;
+
+    return ptr + (offset & mask);
+}
+
+void
+Memory::updateAccessTables()
+{
+    for (unsigned i = 0x00; i <= 0xFF; i++) {
+
+        uint32_t offset = i << 16;
+        uint8_t *peekPtr = NULL;
+        uint8_t *pokePtr = NULL;
+        long *peekCnt = NULL;
+
+        switch (memSrc[i]) {
+
+            case MEM_FAST:
+
+                peekPtr = pokePtr = fast + (offset - FAST_RAM_STRT);
+                peekCnt = &stats.fastReads;
+                break;
+
+            case MEM_ROM:
+
+                peekPtr = bankPtr(rom, romMask, offset);
+                peekCnt = &stats.romReads;
+                break;
+
+            case MEM_WOM:
+
+                peekPtr = bankPtr(wom, womMask, offset);
+                peekCnt = &stats.romReads;
+                break;
+
+            case MEM_EXT:
+
+                peekPtr = bankPtr(ext, extMask, offset);
+                peekCnt = &stats.romReads;
+                break;
+
+            default:
+                break;
+        }
+
+        cpuPeekPtr[i] = peekPtr;
+        cpuPokePtr[i] = pokePtr;
+        cpuPeekCnt[i] = peekCnt;
+    }
+
+    // Decoded Copper instructions may refer to remapped memory
+    copper.clearCache();
+
+    // Invalidate the instruction fetch cache
+    fetchBank = UINT32_MAX;
+    fetchPtr = NULL;
+    fetchCnt = NULL;
+}
+
+bool
+Memory::refillFetchCache(uint32_t addr)
+{
+    uint32_t bank = (addr >> 16) & 0xFF;
+
+    // Only banks that don't require bus arbitration can be cached
+    if (cpuPeekPtr[bank] == NULL) return false;
+
+    fetchBank = bank;
+    fetchPtr = cpuPeekPtr[bank];
+    fetchCnt = cpuPeekCnt[bank];
+    return true;
+}
+
 uint8_t
 Memory::peek8(uint32_t addr)
 {
     // debug("PC: %X peek8(%X)\n", cpu.getPC(), addr);
     addr &= 0xFFFFFF;
+
+    // Fast path: Fast Ram and Rom
+    if (uint8_t *ptr = cpuPeekPtr[addr >> 16]) {
+        (*cpuPeekCnt[addr >> 16])++;
+        uint8_t result = READ_8(ptr + (addr & 0xFFFF));
+
+        // Byte reads from Fast Ram (the only writable bank type) set the data bus
+        if (cpuPokePtr[addr >> 16]) dataBus = result;
+        return result;
+    }
+
     switch (memSrc[addr >> 16]) {
             
         case MEM_UNMAPPED:
@@ -784,6 +883,12 @@ Memory::peek16(uint32_t addr)
 
         case BUS_CPU:
 
+            // Fast path: Fast Ram and Rom
+            if (uint8_t *ptr = cpuPeekPtr[addr >> 16]) {
+                (*cpuPeekCnt[addr >> 16])++;
+                return READ_16(ptr + (addr & 0xFFFF));
+            }
+
             switch (memSrc[addr >> 16]) {
 
                 case MEM_UNMAPPED:
@@ -874,6 +979,16 @@ Memory::peek16(uint32_t addr)
 uint32_t
 Memory::peek32(uint32_t addr)
 {
+    addr &= 0xFFFFFF;
+
+    // Fast path: Fast Ram and Rom (if both words are located in the same bank)
+    if ((addr & 0xFFFF) <= 0xFFFC) {
+        if (uint8_t *ptr = cpuPeekPtr[addr >> 16]) {
+            (*cpuPeekCnt[addr >> 16]) += 2;
+            return READ_32(ptr + (addr & 0xFFFF));
+        }
+    }
+
     return HI_W_LO_W(peek16<BUS_CPU>(addr), peek16<BUS_CPU>(addr + 2));
 }
 
@@ -881,6 +996,10 @@ uint8_t
 Memory::spypeek8(uint32_t addr)
 {
     addr &= 0xFFFFFF;
+
+    // Fast path: Fast Ram and Rom
+    if (uint8_t *ptr = cpuPeekPtr[addr >> 16]) return READ_8(ptr + (addr & 0xFFFF));
+
     switch (memSrc[addr >> 16]) {
             
         case MEM_UNMAPPED: return 0;
@@ -907,6 +1026,10 @@ Memory::spypeek16(uint32_t addr)
     }
 
     addr &= 0xFFFFFF;
+
+    // Fast path: Fast Ram and Rom
+    if (uint8_t *ptr = cpuPeekPtr[addr >> 16]) return READ_16(ptr + (addr & 0xFFFF));
+
     switch (memSrc[addr >> 16]) {
             
         case MEM_UNMAPPED: return 0;
@@ -928,15 +1051,90 @@ Memory::spypeek16(uint32_t addr)
 uint32_t
 Memory::spypeek32(uint32_t addr)
 {
+    addr &= 0xFFFFFF;
+
+    // Fast path: Fast Ram and Rom (if both words are located in the same bank)
+    if ((addr & 0xFFFF) <= 0xFFFC) {
+        if (uint8_t *ptr = cpuPeekPtr[addr >> 16]) return READ_32(ptr + (addr & 0xFFFF));
+    }
+
     return HI_W_LO_W(spypeek16(addr), spypeek16(addr + 2));
 }
 
+void
+Memory::peekChipBlock(uint32_t addr, uint8_t *dst, long count)
+{
+    for (long bytes = 2 * count; bytes > 0;) {
+
+        // Copy up to the end of Chip Ram
+        addr &= chipMask & ~1;
+        long chunk = MIN(bytes, (long)(chipMask + 1 - addr));
+        memcpy(dst, chip + addr, chunk);
+
+        addr += chunk;
+        dst += chunk;
+        bytes -= chunk;
+    }
+}
+
+void
+Memory::pokeChip8(uint32_t addr, uint8_t value)
+{
+    ASSERT_CHIP_ADDR(addr);
+    WRITE_CHIP_8(addr, value);
+    copper.didWriteChip(addr & chipMask, 1);
+}
+
+void
+Memory::pokeChip16(uint32_t addr, uint16_t value)
+{
+    ASSERT_CHIP_ADDR(addr);
+    WRITE_CHIP_16(addr, value);
+    copper.didWriteChip(addr & chipMask);
+}
+
+void
+Memory::pokeChip32(uint32_t addr, uint32_t value)
+{
+    ASSERT_CHIP_ADDR(addr);
+    WRITE_CHIP_32(addr, value);
+    copper.didWriteChip(addr & chipMask, 4);
+}
+
+void
+Memory::pokeChipBlock(uint32_t addr, const uint8_t *src, long count)
+{
+    for (long bytes = 2 * count; bytes > 0;) {
+
+        // Copy up to the end of Chip Ram
+        addr &= chipMask & ~1;
+        long chunk = MIN(bytes, (long)(chipMask + 1 - addr));
+        memcpy(chip + addr, src, chunk);
+        copper.didWriteChip(addr, (uint32_t)chunk);
+
+        addr += chunk;
+        src += chunk;
+        bytes -= chunk;
+    }
+}
+
 void
 Memory::poke8(uint32_t addr, uint8_t value)
 {
     // if (addr >= 0xC2F3A0 && addr <= 0xC2F3B0) debug("**** poke8(%X,%X)\n", addr, value);
 
     addr &= 0xFFFFFF;
+
+    // Fast path: Fast Ram
+    if (uint8_t *ptr = cpuPokePtr[addr >> 16]) {
+        stats.fastWrites++;
+        WRITE_8(ptr + (addr & 0xFFFF), value);
+        return;
+    }
+
+    // Catch up with the CPU if it is running ahead
+    if (cpu.isBatching()) cpu.endBatch();
+
     switch (memSrc[addr >> 16]) {
             
         case MEM_UNMAPPED:
@@ -949,6 +1147,7 @@ Memory::poke8(uint32_t addr, uint8_t value)
             ASSERT_CHIP_ADDR(addr);
             stats.chipWrites++;
             WRITE_CHIP_8(addr, value);
+            copper.didWriteChip(addr & chipMask, 1);
             break;
 
         case MEM_FAST:
@@ -1032,17 +1231,30 @@ Memory::poke16(uint32_t addr, uint16_t value)
         case BUS_COPPER:
 
             ASSERT_CHIP_ADDR(addr);
-            if (memSrc[addr >> 16] != MEM_UNMAPPED) WRITE_CHIP_16(addr, value);
+            if (memSrc[addr >> 16] != MEM_UNMAPPED) {
+                WRITE_CHIP_16(addr, value);
+                copper.didWriteChip(addr & chipMask);
+            }
             return;
 
         case BUS_BLITTER:
 
             ASSERT_CHIP_ADDR(addr);
-            if (memSrc[addr >> 16] != MEM_UNMAPPED) WRITE_CHIP_16(addr, value);
+            if (memSrc[addr >> 16] != MEM_UNMAPPED) {
+                WRITE_CHIP_16(addr, value);
+                copper.didWriteChip(addr & chipMask);
+            }
             return;
 
         case BUS_CPU:
 
+            // Fast path: Fast Ram
+            if (uint8_t *ptr = cpuPokePtr[addr >> 16]) {
+                stats.fastWrites++;
+                WRITE_16(ptr + (addr & 0xFFFF), value);
+                return;
+            }
+
             switch (memSrc[addr >> 16]) {
 
                 case MEM_UNMAPPED:
@@ -1059,6 +1271,7 @@ Memory::poke16(uint32_t addr, uint16_t value)
                     stats.chipWrites++;
                     dataBus = value;
                     WRITE_CHIP_16(addr, value);
+                    copper.didWriteChip(addr & chipMask);
                     return;
 
                 case MEM_FAST:
@@ -1143,6 +1356,17 @@ Memory::poke16(uint32_t addr, uint16_t value)
 void
 Memory::poke32(uint32_t addr, uint32_t value)
 {
+    addr &= 0xFFFFFF;
+
+    // Fast path: Fast Ram (if both words are located in the same bank)
+    if ((addr & 0xFFFF) <= 0xFFFC) {
+        if (uint8_t *ptr = cpuPokePtr[addr >> 16]) {
+            stats.fastWrites += 2;
+            WRITE_32(ptr + (addr & 0xFFFF), value);
+            return;
+        }
+    }
+
     poke16<BUS_CPU>(addr,     HI_WORD(value));
     poke16<BUS_CPU>(addr + 2, LO_WORD(value));
 }
@@ -1996,7 +2220,7 @@ Memory::pokeAutoConf16(uint32_t addr, uint16_t value)
 }
 
 void
-Memory::pokeRom8(uint32_t addr, uint8_t value)
+Memory::pokeRom8(uint32_t , uint8_t )
 {
     // debug("pokeRom8(%X, %X)\n", addr, value);
 
@@ -2009,7 +2233,7 @@ Memory::pokeRom8(uint32_t addr, uint8_t value)
 }
 
 void
-Memory::pokeRom16(uint32_t addr, uint16_t value)
+Memory::pokeRom16(uint32_t , uint16_t )
 {
     // debug("pokeRom16(%X, %X)\n", addr, value);
 
@@ -182,6 +182,30 @@ public:
      */
     MemorySource memSrc[256];
 
+    /* Direct access tables
+     * For each bank, cpuPeekPtr points to the host memory backing this bank
+     * if the CPU can read it without bus arbitration (Fast Ram and all kinds
+     * of Rom). cpuPokePtr does the same for write accesses (Fast Ram only).
+     * All other entries are NULL and the access is dispatched via memSrc.
+     * See also: updateAccessTables()
+     */
+    uint8_t *cpuPeekPtr[256];
+    uint8_t *cpuPokePtr[256];
+
+    // Statistics counters associated with the entries in cpuPeekPtr
+    long *cpuPeekCnt[256];
+
+    /* Instruction fetch cache
+     * Caches the cpuPeekPtr entry of the bank the CPU fetched its most recent
+     * instruction word from. As long as the CPU executes code in Fast Ram or
+     * Rom, fetching an instruction word is a single compare and load. The
+     * cache is invalidated whenever the direct access tables are rebuilt,
+     * i.e., on every memory layout change (overlay, WOM locking, etc.).
+     */
+    uint32_t fetchBank = UINT32_MAX;
+    uint8_t *fetchPtr = NULL;
+    long *fetchCnt = NULL;
+
     // The last value on the data bus
     uint16_t dataBus;
 
@@ -391,6 +415,17 @@ public:
     
     // Updates the memory source lookup table.
     void updateMemSrcTable();
+
+private:
+
+    // Updates the direct access tables (called by updateMemSrcTable())
+    void updateAccessTables();
+
+    // Returns a pointer to the host memory backing a bank (or NULL)
+    uint8_t *bankPtr(uint8_t *ptr, uint32_t mask, uint32_t offset);
+
+    // Tries to cache the bank of the given address in the fetch cache
+    bool refillFetchCache(uint32_t addr);
     
     
     //
@@ -406,6 +441,26 @@ public:
     uint8_t spypeek8(uint32_t addr);
     uint16_t spypeek16(uint32_t addr);
     uint32_t spypeek32(uint32_t addr);
+
+    // Instruction fetches and PC-relative reads (use the fetch cache)
+    inline uint8_t fetch8(uint32_t addr) {
+        if (likely(((addr >> 16) & 0xFF) == fetchBank)) {
+            (*fetchCnt)++; return READ_8(fetchPtr + (addr & 0xFFFF));
+        }
+        return refillFetchCache(addr) ? fetch8(addr) : peek8(addr);
+    }
+    inline uint16_t fetch16(uint32_t addr) {
+        if (likely(((addr >> 16) & 0xFF) == fetchBank)) {
+            (*fetchCnt)++; return READ_16(fetchPtr + (addr & 0xFFFF));
+        }
+        return refillFetchCache(addr) ? fetch16(addr) : peek16<BUS_CPU>(addr);
+    }
+    inline uint32_t fetch32(uint32_t addr) {
+        if (likely(((addr >> 16) & 0xFF) == fetchBank && (addr & 0xFFFF) <= 0xFFFC)) {
+            (*fetchCnt) += 2; return READ_32(fetchPtr + (addr & 0xFFFF));
+        }
+        return HI_W_LO_W(fetch16(addr), fetch16(addr + 2));
+    }
     
     void poke8(uint32_t addr, uint8_t value);
     template <BusOwner owner> void poke16(uint32_t addr, uint16_t value);
@@ -436,15 +491,15 @@ public:
         return peekChip32(addr);
     }
     
-    inline void pokeChip8(uint32_t addr, uint8_t value) {
-        ASSERT_CHIP_ADDR(addr); WRITE_CHIP_8(addr, value);
-    }
-    inline void pokeChip16(uint32_t addr, uint16_t value) {
-        ASSERT_CHIP_ADDR(addr); WRITE_CHIP_16(addr, value);
-    }
-    inline void pokeChip32(uint32_t addr, uint32_t value) {
-        ASSERT_CHIP_ADDR(addr); WRITE_CHIP_32(addr, value);
-    }
+    void pokeChip8(uint32_t addr, uint8_t value);
+    void pokeChip16(uint32_t addr, uint16_t value);
+    void pokeChip32(uint32_t addr, uint32_t value);
+
+    /* Copies a block of words from or into Chip Ram. The data is stored in
+     * big endian format. Addresses wrap around at the end of Chip Ram.
+     */
+    void peekChipBlock(uint32_t addr, uint8_t *dst, long count);
+    void pokeChipBlock(uint32_t addr, const uint8_t *src, long count);
     
     //
     // CIA space
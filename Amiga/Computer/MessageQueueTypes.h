@@ -75,6 +75,8 @@ typedef enum
     MSG_AUTOSNAPSHOT_SAVED,
     MSG_USERSNAPSHOT_LOADED,
     MSG_USERSNAPSHOT_SAVED,
+    MSG_SNAPSHOT_WRITTEN,
+    MSG_SNAPSHOT_WRITE_ERROR,
 }
 MessageType;
 
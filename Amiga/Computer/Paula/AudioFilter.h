@@ -46,7 +46,7 @@ public:
     }
 
     template <class T>
-    void applyToResetItems(T& worker)
+    void applyToResetItems(T& )
     {
     }
     
@@ -88,7 +88,7 @@ AudioUnit::_dump()
 }
 
 size_t
-AudioUnit::didLoadFromBuffer(uint8_t *buffer)
+AudioUnit::didLoadFromBuffer(uint8_t *)
 {
     clearRingbuffer();
     return 0;
@@ -357,7 +357,7 @@ AudioUnit::handleBufferUnderflow()
     debug(AUDBUF_DEBUG, "SID RINGBUFFER UNDERFLOW (r: %ld w: %ld)\n", readPtr, writePtr);
     
     // Determine the elapsed seconds since the last pointer adjustment.
-    uint64_t now = mach_absolute_time();
+    uint64_t now = timeInNanos();
     double elapsedTime = (double)(now - lastAlignment) / 1000000000.0;
     lastAlignment = now;
     
@@ -386,7 +386,7 @@ AudioUnit::handleBufferOverflow()
     debug(AUDBUF_DEBUG, "SID RINGBUFFER OVERFLOW (r: %ld w: %ld)\n", readPtr, writePtr);
     
     // Determine the elapsed seconds since the last pointer adjustment.
-    uint64_t now = mach_absolute_time();
+    uint64_t now = timeInNanos();
     double elapsedTime = (double)(now - lastAlignment) / 1000000000.0;
     lastAlignment = now;
     
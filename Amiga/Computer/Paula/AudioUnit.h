@@ -274,7 +274,7 @@ public:
     void handleBufferOverflow();
     
     // Signals to ignore the next underflow or overflow condition.
-    void ignoreNextUnderOrOverflow() { lastAlignment = mach_absolute_time(); }
+    void ignoreNextUnderOrOverflow() { lastAlignment = timeInNanos(); }
     
     // Moves the read pointer forward
     void advanceReadPtr() { readPtr = (readPtr + 1) % bufferSize; }
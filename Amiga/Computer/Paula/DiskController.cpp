@@ -19,6 +19,9 @@ DiskController::DiskController(Amiga& ref) : SubComponent(ref)
     config.connected[2] = false;
     config.connected[3] = false;
     config.useFifo = true;
+    config.writeBack = false;
+    config.autoWarp = false;
+    config.autoWarpDelay = 50;
 }
 
 void
@@ -71,6 +74,8 @@ DiskController::_dumpConfig()
     plainmsg("          df2 : %s\n", config.connected[2] ? "connected" : "not connected");
     plainmsg("          df3 : %s\n", config.connected[3] ? "connected" : "not connected");
     plainmsg("      useFifo : %s\n", config.useFifo ? "yes" : "no");
+    plainmsg("    writeBack : %s\n", config.writeBack ? "yes" : "no");
+    plainmsg("     autoWarp : %s (delay: %d frames)\n", config.autoWarp ? "yes" : "no", config.autoWarpDelay);
 }
 
 void
@@ -159,6 +164,43 @@ DiskController::setUseFifo(bool value)
     pthread_mutex_unlock(&lock);
 }
 
+void
+DiskController::setWriteBack(bool value)
+{
+    pthread_mutex_lock(&lock);
+    config.writeBack = value;
+    pthread_mutex_unlock(&lock);
+}
+
+void
+DiskController::setAutoWarp(bool value)
+{
+    pthread_mutex_lock(&lock);
+    config.autoWarp = value;
+    
+    // Hand control over warp mode back to the caller
+    autoWarping = false;
+    pthread_mutex_unlock(&lock);
+}
+
+void
+DiskController::setAutoWarpDelay(long frames)
+{
+    pthread_mutex_lock(&lock);
+    config.autoWarpDelay = frames;
+    pthread_mutex_unlock(&lock);
+}
+
+void
+DiskController::flushDisks()
+{
+    for (unsigned i = 0; i < 4; i++) {
+        
+        Disk *disk = df[i]->disk;
+        if (disk && disk->isModified() && disk->canFlush()) disk->flush();
+    }
+}
+
 
 Drive *
 DiskController::getSelectedDrive()
@@ -295,12 +337,15 @@ DiskController::pokeDSKLEN(uint16_t newDskLen)
         }
     }
     
+    // Remember the transfer for the auto-warp logic
+    if (state != DRIVE_DMA_OFF && drive && drive->motor) dmaStarted = true;
+
     // If the selected drive is a turbo drive, perform DMA immediately
     if (drive && drive->isTurbo()) performTurboDMA(drive);
 }
 
 void
-DiskController::pokeDSKDAT(uint16_t value)
+DiskController::pokeDSKDAT(uint16_t )
 {
     debug(DSKREG_DEBUG, "pokeDSKDAT\n");
 
@@ -435,7 +480,38 @@ DiskController::serviceDiskChangeEvent(EventID id, int driveNr)
 void
 DiskController::vsyncHandler()
 {
- 
+    // Write modified disks back to their ADF files once in a while
+    if (config.writeBack && agnus.frame % (5 * 50) == 0) flushDisks();
+
+    // Speed up the emulator while disk data is transferred
+    if (config.autoWarp) updateAutoWarp();
+}
+
+void
+DiskController::updateAutoWarp()
+{
+    Drive *drive = getSelectedDrive();
+    
+    // Check for disk DMA activity since the last VSYNC
+    bool active = dmaStarted || (state != DRIVE_DMA_OFF && drive && drive->motor);
+    dmaStarted = false;
+    
+    if (active) {
+        
+        if (!amiga.getWarp()) {
+            
+            debug(DSK_DEBUG, "Auto-warp on\n");
+            autoWarping = true;
+            amiga.warpOn();
+        }
+        autoWarpCountdown = config.autoWarpDelay;
+        
+    } else if (autoWarping && --autoWarpCountdown <= 0) {
+        
+        debug(DSK_DEBUG, "Auto-warp off\n");
+        autoWarping = false;
+        amiga.warpOff();
+    }
 }
 
 void
@@ -591,35 +667,31 @@ DiskController::performDMARead(Drive *drive, uint32_t remaining)
     // Only proceed if the FIFO contains enough data.
     if (!fifoHasWord()) { return; }
 
-    do {
-        // Read next word from the FIFO buffer.
-        uint16_t word = readFifo16();
-        
-        // Write word into memory.
-        agnus.doDiskDMA(word);
-        // if (dsksync) { plainmsg("word = %x pos = %d dsklen = %d checkcnt = %d checksum = %x\n", word, drive->head.offset, dsklen & 0x3FFF, checkcnt, checksum); }
+    // Don't read beyond the end of the block.
+    uint32_t count = MIN(remaining, dsklen & 0x3FFF);
 
-        // Compute checksum (for debugging).
-        checksum = fnv_1a_it32(checksum, word);
-        checkcnt++;
+    // Read next word from the FIFO buffer.
+    uint16_t word = readFifo16();
+    
+    // Write word into memory.
+    agnus.doDiskDMA(word);
+    // if (dsksync) { plainmsg("word = %x pos = %d dsklen = %d checkcnt = %d checksum = %x\n", word, drive->head.offset, dsklen & 0x3FFF, checkcnt, checksum); }
 
-        // Finish up if this was the last word to transfer.
-        if ((--dsklen & 0x3FFF) == 0) {
+    // Compute checksum (for debugging).
+    checksum = fnv_1a_it32(checksum, word);
+    checkcnt++;
 
-            paula.raiseIrq(INT_DSKBLK);
-            state = DRIVE_DMA_OFF;
-            plaindebug(DSK_CHECKSUM, "performRead: checkcnt = %d checksum = %X\n", checkcnt, checksum);
-            return;
-        }
-        
-        // If the loop repeats, do what the event handler would do in between.
-        if (--remaining) {
-            executeFifo();
-            executeFifo();
-            assert(fifoHasWord());
-        }
-        
-    } while (remaining);
+    // If more words are requested, transfer them in a single block.
+    if (count > 1) performBulkDMARead(drive, count - 1);
+
+    // Finish up if the last word has been transferred.
+    dsklen -= count;
+    if ((dsklen & 0x3FFF) == 0) {
+
+        paula.raiseIrq(INT_DSKBLK);
+        state = DRIVE_DMA_OFF;
+        plaindebug(DSK_CHECKSUM, "performRead: checkcnt = %d checksum = %X\n", checkcnt, checksum);
+    }
 }
 
 void
@@ -630,52 +702,130 @@ DiskController::performDMAWrite(Drive *drive, uint32_t remaining)
     // Only proceed if the FIFO has enough free space.
     if (!fifoCanStoreWord()) return;
 
-    do {
-        // Read next word from memory.
-        uint16_t word = agnus.doDiskDMA(); // dmaRead();
-        checksum = fnv_1a_it32(checksum, word);
-        checkcnt++;
-        // plaindebug("%d: %X (%X)\n", dsklen & 0x3FFF, word, dcheck);
-        
-        // Write word into FIFO buffer.
-        assert(fifoCount <= 4);
-        writeFifo(HI_BYTE(word));
-        writeFifo(LO_BYTE(word));
+    // Don't write beyond the end of the block.
+    uint32_t count = MIN(remaining, dsklen & 0x3FFF);
+
+    // If more words are requested, transfer all but the last one in a block.
+    if (count > 1) performBulkDMAWrite(drive, count - 1);
 
-        // Finish up if this was the last word to transfer.
-        if ((--dsklen & 0x3FFF) == 0) {
+    // Read next word from memory.
+    uint16_t word = agnus.doDiskDMA(); // dmaRead();
+    checksum = fnv_1a_it32(checksum, word);
+    checkcnt++;
+    // plaindebug("%d: %X (%X)\n", dsklen & 0x3FFF, word, dcheck);
+    
+    // Write word into FIFO buffer.
+    assert(fifoCount <= 4);
+    writeFifo(HI_BYTE(word));
+    writeFifo(LO_BYTE(word));
 
-            paula.raiseIrq(INT_DSKBLK);
+    // Finish up if this was the last word to transfer.
+    dsklen -= count;
+    if ((dsklen & 0x3FFF) == 0) {
 
-            /* The timing-accurate approach: Set state to DRIVE_DMA_FLUSH.
-             * The event handler recognises this state and switched to
-             * DRIVE_DMA_OFF once the FIFO has been emptied.
-             */
-            
-            // state = DRIVE_DMA_FLUSH;
+        paula.raiseIrq(INT_DSKBLK);
+
+        /* The timing-accurate approach: Set state to DRIVE_DMA_FLUSH.
+         * The event handler recognises this state and switched to
+         * DRIVE_DMA_OFF once the FIFO has been emptied.
+         */
+        
+        // state = DRIVE_DMA_FLUSH;
+        
+        /* I'm unsure of the timing-accurate approach works properly,
+         * because the disk IRQ would be triggered before the last byte
+         * has been written.
+         * Hence, we play safe here and flush the FIFO immediately.
+         */
+        while (!fifoIsEmpty()) {
+            drive->writeHead(readFifo());
+        }
+        state = DRIVE_DMA_OFF;
+        
+        debug(DSK_CHECKSUM, "performWrite: checkcnt = %d checksum = %X\n", checkcnt, checksum);
+    }
+}
+
+void
+DiskController::performBulkDMARead(Drive *drive, uint32_t count)
+{
+    assert(drive != NULL);
+    assert(state == DRIVE_DMA_READ);
+
+    // Bytes in the FIFO, followed by up to 256 words from the drive
+    uint8_t buffer[6 + 512];
+    
+    while (count) {
+        
+        uint32_t words = MIN(count, 256);
+        long old = fifoCount, total = old + 2 * words;
+        
+        // Place the buffered bytes in front of the new ones (oldest first)
+        for (long i = 0; i < old; i++) {
+            buffer[i] = (fifo >> (8 * (old - 1 - i))) & 0xFF;
+        }
+        
+        // Read the new bytes from the drive
+        drive->readHead(buffer + old, 2 * words);
+        
+        /* Scan for SYNC marks. A comparison only takes place if the FIFO
+         * contains a full word. If the FIFO was drained completely, this is
+         * not the case after the first byte of each pair has been written.
+         */
+        for (long i = old ? old : old + 1; i < total; i += old ? 1 : 2) {
             
-            /* I'm unsure of the timing-accurate approach works properly,
-             * because the disk IRQ would be triggered before the last byte
-             * has been written.
-             * Hence, we play safe here and flush the FIFO immediately.
-             */
-            while (!fifoIsEmpty()) {
-                drive->writeHead(readFifo());
+            if (HI_LO(buffer[i - 1], buffer[i]) == dsksync) {
+                debug(DSK_DEBUG, "SYNC IRQ (dsklen = %d)\n", dsklen);
+                paula.raiseIrq(INT_DSKSYN);
             }
-            state = DRIVE_DMA_OFF;
-            
-            debug(DSK_CHECKSUM, "performWrite: checkcnt = %d checksum = %X\n", checkcnt, checksum);
-            return;
         }
+        syncFlag = HI_LO(buffer[total - 2], buffer[total - 1]) == dsksync;
+        incoming = buffer[total - 1];
+        incomingCycle = agnus.clock;
+        
+        // Feed the new bytes into the FIFO
+        for (long i = old; i < total; i++) fifo = (fifo << 8) | buffer[i];
+        
+        // Write the oldest words into memory. The FIFO keeps the rest.
+        agnus.doDiskDMAToMemory(buffer, words);
+        updateChecksum(buffer, words);
+        
+        count -= words;
+    }
+}
+
+void
+DiskController::performBulkDMAWrite(Drive *drive, uint32_t count)
+{
+    assert(drive != NULL);
+    assert(state == DRIVE_DMA_WRITE);
+    assert(fifoCount <= 4);
+
+    // Bytes in the FIFO, followed by up to 256 words from memory
+    uint8_t buffer[4 + 512];
+    
+    while (count) {
+        
+        uint32_t words = MIN(count, 256);
+        long old = fifoCount, total = old + 2 * words;
         
-        // If the loop repeats, do what the event handler would do in between.
-        if (--remaining) {
-            executeFifo();
-            executeFifo();
-            assert(fifoCanStoreWord());
+        // Place the buffered bytes in front of the new ones (oldest first)
+        for (long i = 0; i < old; i++) {
+            buffer[i] = (fifo >> (8 * (old - 1 - i))) & 0xFF;
         }
         
-    } while (remaining);
+        // Read the new words from memory
+        agnus.doDiskDMAFromMemory(buffer + old, words);
+        updateChecksum(buffer + old, words);
+        
+        // Feed the new bytes into the FIFO
+        for (long i = old; i < total; i++) fifo = (fifo << 8) | buffer[i];
+        
+        // Write the oldest bytes to disk. The FIFO keeps the rest.
+        drive->writeHead(buffer, 2 * words);
+        
+        count -= words;
+    }
 }
 
 void
@@ -718,25 +868,30 @@ DiskController::performSimpleDMARead(Drive *drive, uint32_t remaining)
 {
     assert(drive != NULL);
 
-    for (unsigned i = 0; i < remaining; i++) {
+    // Don't read beyond the end of the block.
+    uint32_t count = MIN(remaining, dsklen & 0x3FFF);
+    uint8_t buffer[512];
+
+    for (uint32_t i = 0, words; i < count; i += words) {
+        
+        words = MIN(count - i, sizeof(buffer) / 2);
         
-        // Read word from disk.
-        uint16_t word = drive->readHead16();
+        // Read words from disk.
+        drive->readHead(buffer, 2 * words);
         
-        // Write word into memory.
-        agnus.doDiskDMA(word);
+        // Write words into memory.
+        agnus.doDiskDMAToMemory(buffer, words);
 
         // Compute checksum (for debugging).
-        checksum = fnv_1a_it32(checksum, word);
-        checkcnt++;
-
-        if ((--dsklen & 0x3FFF) == 0) {
+        updateChecksum(buffer, words);
+    }
+    
+    dsklen -= count;
+    if ((dsklen & 0x3FFF) == 0) {
 
-            paula.raiseIrq(INT_DSKBLK);
-            state = DRIVE_DMA_OFF;
-            debug(DSK_DEBUG, "doSimpleDMARead: checkcnt = %d checksum = %X\n", checkcnt, checksum);
-            return;
-        }
+        paula.raiseIrq(INT_DSKBLK);
+        state = DRIVE_DMA_OFF;
+        debug(DSK_DEBUG, "doSimpleDMARead: checkcnt = %d checksum = %X\n", checkcnt, checksum);
     }
 }
 
@@ -746,25 +901,30 @@ DiskController::performSimpleDMAWrite(Drive *drive, uint32_t remaining)
     assert(drive != NULL);
     // debug("Writing %d words to disk\n", dsklen & 0x3FFF);
 
-    for (unsigned i = 0; i < remaining; i++) {
+    // Don't write beyond the end of the block.
+    uint32_t count = MIN(remaining, dsklen & 0x3FFF);
+    uint8_t buffer[512];
+
+    for (uint32_t i = 0, words; i < count; i += words) {
         
-        // Read word from memory
-        uint16_t word = agnus.doDiskDMA();
+        words = MIN(count - i, sizeof(buffer) / 2);
+        
+        // Read words from memory
+        agnus.doDiskDMAFromMemory(buffer, words);
         
         // Compute checksum (for debugging)
-        checksum = fnv_1a_it32(checksum, word);
-        checkcnt++;
+        updateChecksum(buffer, words);
 
-        // Write word to disk
-        drive->writeHead16(word);
+        // Write words to disk
+        drive->writeHead(buffer, 2 * words);
+    }
+    
+    dsklen -= count;
+    if ((dsklen & 0x3FFF) == 0) {
         
-        if ((--dsklen & 0x3FFF) == 0) {
-            
-            paula.raiseIrq(INT_DSKBLK);
-            state = DRIVE_DMA_OFF;
-            debug(DSK_DEBUG, "doSimpleDMAWrite: checkcnt = %d checksum = %X\n", checkcnt, checksum);
-            return;
-        }
+        paula.raiseIrq(INT_DSKBLK);
+        state = DRIVE_DMA_OFF;
+        debug(DSK_DEBUG, "doSimpleDMAWrite: checkcnt = %d checksum = %X\n", checkcnt, checksum);
     }
 }
 
@@ -784,7 +944,7 @@ DiskController::performTurboDMA(Drive *drive)
 
         case DRIVE_DMA_WAIT:
 
-            drive->findSyncMark();
+            drive->findSyncMark(dsksync);
             // fallthrough
 
         case DRIVE_DMA_READ:
@@ -811,18 +971,22 @@ DiskController::performTurboRead(Drive *drive)
 {
     // debug(DSK_CHECKSUM, "Turbo-reading %d words from disk (offset = %d).\n", dsklen & 0x3FFF, drive->head.offset);
 
-    for (unsigned i = 0; i < (dsklen & 0x3FFF); i++) {
+    uint32_t count = dsklen & 0x3FFF;
+    uint8_t buffer[4096];
+    
+    for (uint32_t i = 0, words; i < count; i += words) {
         
-        // Read word from disk.
-        uint16_t word = drive->readHead16();
+        words = MIN(count - i, sizeof(buffer) / 2);
         
-        // Write word into memory.
-        mem.pokeChip16(agnus.dskpt, word);
-        INC_CHIP_PTR(agnus.dskpt);
+        // Read words from disk.
+        drive->readHead(buffer, 2 * words);
+        
+        // Write words into memory.
+        mem.pokeChipBlock(agnus.dskpt, buffer, words);
+        INC_CHIP_PTR_BY(agnus.dskpt, 2 * words);
         
         // Compute checksum (for debugging)
-        checksum = fnv_1a_it32(checksum, word);
-        checkcnt++;
+        updateChecksum(buffer, words);
     }
         
     plaindebug(DSK_CHECKSUM, "Turbo read %s: cyl: %d side: %d offset: %d checkcnt = %d checksum = %X\n", drive->getDescription(), drive->head.cylinder, drive->head.side, drive->head.offset, checkcnt, checksum);
@@ -833,20 +997,32 @@ DiskController::performTurboWrite(Drive *drive)
 {
     plaindebug(DSK_CHECKSUM, "Turbo-writing %d words to disk.\n", dsklen & 0x3FFF);
     
-    for (unsigned i = 0; i < (dsklen & 0x3FFF); i++) {
+    uint32_t count = dsklen & 0x3FFF;
+    uint8_t buffer[4096];
+    
+    for (uint32_t i = 0, words; i < count; i += words) {
         
-        // Read word from memory
-        uint16_t word = mem.peekChip16(agnus.dskpt);
-        INC_CHIP_PTR(agnus.dskpt);
+        words = MIN(count - i, sizeof(buffer) / 2);
+        
+        // Read words from memory
+        mem.peekChipBlock(agnus.dskpt, buffer, words);
+        INC_CHIP_PTR_BY(agnus.dskpt, 2 * words);
         
         // Compute checksum (for debugging)
-        checksum = fnv_1a_it32(checksum, word);
-        checkcnt++;
+        updateChecksum(buffer, words);
 
-        // Write word to disk
-        drive->writeHead16(word);
+        // Write words to disk
+        drive->writeHead(buffer, 2 * words);
     }
     
     plaindebug(DSK_CHECKSUM, "Turbo write %s: checkcnt = %d checksum = %X\n", drive->getDescription(), checkcnt, checksum);
 }
 
+void
+DiskController::updateChecksum(const uint8_t *words, long count)
+{
+    for (long i = 0; i < count; i++) {
+        checksum = fnv_1a_it32(checksum, HI_LO(words[2 * i], words[2 * i + 1]));
+    }
+    checkcnt += count;
+}
@@ -42,6 +42,16 @@ class DiskController : public SubComponent {
     // Indicates if the current disk operation used FIFO buffering
     bool useFifo;
 
+    /* Auto-warp bookkeeping. While auto-warp is enabled, the controller puts
+     * the emulator into warp mode when a DMA transfer is started and returns
+     * to normal speed a configurable number of frames after the last one.
+     * Variable 'dmaStarted' catches transfers that begin and end between two
+     * VSYNCs, which is always the case for turbo drives.
+     */
+    bool autoWarping = false;
+    bool dmaStarted = false;
+    long autoWarpCountdown = 0;
+
     // Set to true if the currently read disk word matches the sync word.
     // NOT USED AT THE MOMENT
     bool syncFlag = false;
@@ -144,6 +154,22 @@ public:
 
     // Enables or disables the emulation of a FIFO buffer
     void setUseFifo(bool value);
+    
+    /* Enables or disables writing modified disks back to their ADF files.
+     * If enabled, all modified tracks are written back every few seconds
+     * and when a disk is ejected.
+     */
+    void setWriteBack(bool value);
+    
+    // Writes all modified disks back to their ADF files
+    void flushDisks();
+
+    /* Enables or disables auto-warp. If enabled, the emulator runs in warp
+     * mode while a drive transfers data. It returns to normal speed after
+     * the specified number of frames without any disk DMA activity.
+     */
+    void setAutoWarp(bool value);
+    void setAutoWarpDelay(long frames);
 
     
     //
@@ -289,6 +315,9 @@ private:
     // Returns true if the next word to read matches the specified value
     bool compareFifo(uint16_t word);
 
+    // Switches warp mode on or off, depending on the current disk activity
+    void updateAutoWarp();
+
     /* Emulates a data transfert between the selected drive and the FIFO buffer.
      * This function is executed periodically in serviceDiskEvent().
      * The exact operation is dependent of the current DMA state. If DMA is
@@ -327,12 +356,24 @@ public:
      * With these drives, data is transferred immediately when the DSKLEN
      * register is written. This mode is the least compatible. Neither does it
      * uses the rasterline DMA slots, nor does it use a FIFO buffer.
+     *
+     * In all modes, multiple words are transferred as a single block if the
+     * drive is accelerated. The block transfer has the same effect as moving
+     * the words one by one. Checksums, SYNC interrupts, index pulses, and the
+     * contents of the FIFO buffer are updated in exactly the same way.
      */
   
     // 1. Standard DMA mode
     void performDMA();
     void performDMARead(Drive *drive, uint32_t count);
     void performDMAWrite(Drive *drive, uint32_t count);
+
+    /* Emulates multiple DMA cycles in standard DMA mode at once. Each cycle
+     * is preceded (read) or followed (write) by two FIFO cycles, just as if
+     * executeFifo() was called twice.
+     */
+    void performBulkDMARead(Drive *drive, uint32_t count);
+    void performBulkDMAWrite(Drive *drive, uint32_t count);
  
     // 2. Simple DMA mode
     void performSimpleDMA();
@@ -343,6 +384,9 @@ public:
     void performTurboDMA(Drive *d);
     void performTurboRead(Drive *drive);
     void performTurboWrite(Drive *drive);
+
+    // Updates the debug checksum with a block of words
+    void updateChecksum(const uint8_t *words, long count);
 };
 
 #endif
@@ -87,6 +87,9 @@ typedef struct
 {
     bool connected[4];
     bool useFifo;
+    bool writeBack;
+    bool autoWarp;
+    long autoWarpDelay;
 }
 DiskControllerConfig;
 
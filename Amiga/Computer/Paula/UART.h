@@ -60,7 +60,7 @@ public:
     //
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
     }
     
@@ -178,7 +178,7 @@ void
 RTC::registers2time()
 {
     // Read the registers.
-    tm t = {0};
+    tm t = {};
     t.tm_sec  = reg[0] + 10 * reg[1];
     t.tm_min  = reg[2] + 10 * reg[3];
     t.tm_hour = reg[4] + 10 * reg[5];
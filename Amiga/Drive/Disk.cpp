@@ -8,6 +8,10 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "sse_utils.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
 
 Disk::Disk(DiskType type)
 {
@@ -19,8 +23,13 @@ Disk::Disk(DiskType type)
     clearDisk();
 }
 
+Disk::~Disk()
+{
+    releaseSectors();
+}
+
 long
-Disk::numSides(DiskType type)
+Disk::numSides(DiskType )
 {
     return 2;
 }
@@ -86,9 +95,55 @@ Disk::makeWithReader(SerReader &reader, DiskType diskType)
     Disk *disk = new Disk(diskType);
     disk->applyToPersistentItems(reader);
     
+    // Read the sector data
+    bool hasSectors;
+    reader & hasSectors;
+    if (hasSectors) {
+        disk->sectorData.resize(disk->numSectorsTotal() * 512);
+        reader.copy(disk->sectorData.data(), disk->sectorData.size());
+        disk->sectors = disk->sectorData.data();
+    }
+    
+    // Read all encoded tracks
+    for (Track t = 0; t < maxTracks; t++) {
+        if (disk->encoded[t]) reader.copy(disk->data.track[t], trackSize);
+    }
+    
     return disk;
 }
 
+size_t
+Disk::serializedSize()
+{
+    SerCounter counter;
+    applyToPersistentItems(counter);
+    
+    counter.count += sizeof(bool);
+    if (sectors) counter.count += numSectorsTotal() * 512;
+    
+    for (Track t = 0; t < maxTracks; t++) {
+        if (encoded[t]) counter.count += trackSize;
+    }
+    
+    return counter.count;
+}
+
+void
+Disk::serialize(SerWriter &writer)
+{
+    applyToPersistentItems(writer);
+    
+    // Write the sector data
+    checkMapping();
+    writer & (sectors != NULL);
+    if (sectors) writer.copy(sectors, numSectorsTotal() * 512);
+    
+    // Write all encoded tracks
+    for (Track t = 0; t < maxTracks; t++) {
+        if (encoded[t]) writer.copy(data.track[t], trackSize);
+    }
+}
+
 uint8_t
 Disk::readByte(Cylinder cylinder, Side side, uint16_t offset)
 {
@@ -96,6 +151,7 @@ Disk::readByte(Cylinder cylinder, Side side, uint16_t offset)
     assert(isValidSideNr(side));
     assert(offset < trackSize);
 
+    prepareTrack(2 * cylinder + side);
     return data.cyclinder[cylinder][side][offset];
 }
 
@@ -106,9 +162,65 @@ Disk::writeByte(uint8_t value, Cylinder cylinder, Side side, uint16_t offset)
     assert(isValidSideNr(side));
     assert(offset < trackSize);
     
+    prepareTrack(2 * cylinder + side);
+    dirty[2 * cylinder + side] = true;
+    modified = true;
     data.cyclinder[cylinder][side][offset] = value;
 }
 
+void
+Disk::readBytes(uint8_t *dst, Cylinder cylinder, Side side, uint16_t offset, long count)
+{
+    assert(isValidCylinderNr(cylinder));
+    assert(isValidSideNr(side));
+    assert(offset + count <= trackSize);
+
+    prepareTrack(2 * cylinder + side);
+    memcpy(dst, &data.cyclinder[cylinder][side][offset], count);
+}
+
+void
+Disk::writeBytes(const uint8_t *src, Cylinder cylinder, Side side, uint16_t offset, long count)
+{
+    assert(isValidCylinderNr(cylinder));
+    assert(isValidSideNr(side));
+    assert(offset + count <= trackSize);
+
+    prepareTrack(2 * cylinder + side);
+    dirty[2 * cylinder + side] = true;
+    modified = true;
+    memcpy(&data.cyclinder[cylinder][side][offset], src, count);
+}
+
+long
+Disk::findWord(uint16_t word, Cylinder cylinder, Side side, uint16_t offset)
+{
+    assert(isValidCylinderNr(cylinder));
+    assert(isValidSideNr(side));
+    assert(offset < trackSize);
+
+    prepareTrack(2 * cylinder + side);
+    uint8_t *track = data.cyclinder[cylinder][side];
+    uint8_t hi = HI_BYTE(word), lo = LO_BYTE(word);
+
+    // Scan from the offset to the end first and from the start to the offset
+    long ranges[2][2] = { { offset, trackSize }, { 0, offset } };
+
+    for (auto &r : ranges) {
+
+        const uint8_t *p = track + r[0], *end = track + r[1];
+
+        // Check the second byte for each occurrence of the first one
+        while ((p = (const uint8_t *)memchr(p, hi, end - p))) {
+
+            long pos = p - track;
+            if (track[(pos + 1) % trackSize] == lo) return pos;
+            p++;
+        }
+    }
+    return -1;
+}
+
 uint8_t
 Disk::addClockBits(uint8_t value, uint8_t previous)
 {
@@ -131,13 +243,19 @@ void
 Disk::clearDisk()
 {
     assert(sizeof(data) == sizeof(data.raw));
-    memset(data.raw, 0xAA, sizeof(data));
+    
+    // All tracks are cleared when they are accessed for the first time
+    releaseSectors();
+    for (Track t = 0; t < maxTracks; t++) {
+        encoded[t] = false;
+        dirty[t] = false;
+    }
 }
 
 void
 Disk::clearTrack(Track t)
 {
-    assert(isValidTrack(t));
+    assert(t >= 0 && t < maxTracks);
     memset(data.track[t], 0xAA, trackSize);
 }
 
@@ -147,34 +265,191 @@ Disk::encodeDisk(ADFFile *adf)
     assert(adf != NULL);
     assert(adf->getDiskType() == getType());
     
-    bool result = true;
     long tmax = numTracks();
     long smax = numSectors();
     
-    debug("Encoding disk (%d tracks, %d sectors each)...\n", tmax, smax);
+    if (adf->getSize() != (size_t)(tmax * smax * 512) || tmax > maxTracks) {
+        warn("Disk size does not match the ADF size\n");
+        return false;
+    }
     
-    for (Track t = 0; t < tmax; t++) {
-        result &= encodeTrack(adf, t, smax);
+    debug("Preparing disk (%d tracks, %d sectors each)...\n", tmax, smax);
+    
+    clearDisk();
+    
+    // Prefer reading the sector data directly from the file
+    if (mapFile(adf->getPath(), adf->getSize()) &&
+        memcmp(mapping, adf->getData(), mappingSize) == 0) {
+        
+        debug("Using %s as sector data\n", adf->getPath());
+        return true;
     }
+    
+    releaseSectors();
+    sectorData.resize(adf->getSize());
+    adf->writeToBuffer(sectorData.data());
+    sectors = sectorData.data();
+    
+    return true;
+}
 
+bool
+Disk::mapFile(const char *path, size_t size)
+{
+    assert(mapping == NULL);
+    
+    struct stat fileProperties;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    
+    if (fstat(fd, &fileProperties) != 0 || (size_t)fileProperties.st_size != size) {
+        close(fd);
+        return false;
+    }
+    
+    /* Modifications never reach the file through the mapping. flush() writes
+     * the decoded tracks with pwrite() and only if write-back is enabled.
+     */
+    void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    
+    if (buffer == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    
+    mapping = sectors = (uint8_t *)buffer;
+    mappingSize = size;
+    mappingFd = fd;
+    mappingPath = path;
+    mappingIsWritable = access(path, W_OK) == 0;
+    return true;
+}
+
+void
+Disk::checkMapping()
+{
+    struct stat fileProperties;
+    
+    if (mapping == NULL) return;
+    if (fstat(mappingFd, &fileProperties) != 0) return;
+    if ((size_t)fileProperties.st_size == mappingSize) return;
+    
+    warn("%s has changed its size. Detaching the disk from the file.\n",
+         mappingPath.c_str());
+    
+    // Rescue the part of the file that still exists
+    size_t valid = MIN((size_t)fileProperties.st_size, mappingSize);
+    vector<uint8_t> copy(mappingSize, 0);
+    memcpy(copy.data(), mapping, valid);
+    
+    releaseSectors();
+    sectorData.swap(copy);
+    sectors = sectorData.data();
+}
+
+void
+Disk::releaseSectors()
+{
+    if (mapping) munmap(mapping, mappingSize);
+    if (mappingFd >= 0) close(mappingFd);
+    
+    mapping = NULL;
+    mappingSize = 0;
+    mappingFd = -1;
+    mappingPath.clear();
+    mappingIsWritable = false;
+    sectorData.clear();
+    sectors = NULL;
+}
+
+bool
+Disk::flush()
+{
+    checkMapping();
+    if (!mappingIsWritable) return false;
+    
+    struct stat fileProperties, mappedProperties;
+    
+    // Make sure the file has not been replaced or resized in the meantime
+    int fd = open(mappingPath.c_str(), O_WRONLY);
+    if (fd < 0) return false;
+    
+    if (fstat(fd, &fileProperties) != 0 ||
+        fstat(mappingFd, &mappedProperties) != 0 ||
+        fileProperties.st_dev != mappedProperties.st_dev ||
+        fileProperties.st_ino != mappedProperties.st_ino ||
+        (size_t)fileProperties.st_size != mappingSize) {
+        
+        warn("%s has changed. Modified tracks are not written back.\n",
+             mappingPath.c_str());
+        close(fd);
+        return false;
+    }
+    
+    bool result = true;
+    long smax = numSectors();
+    size_t trackBytes = smax * 512;
+    size_t bytes = 0;
+    
+    for (Track t = 0; t < numTracks(); t++) {
+        
+        if (!dirty[t]) continue;
+        
+        // Decode the track into the private mapping (untouched if corrupted)
+        uint8_t *track = mapping + t * trackBytes;
+        if (!decodeTrack(track, t, smax)) {
+            result = false;
+            continue;
+        }
+        
+        // Write the track to the file
+        if (pwrite(fd, track, trackBytes, t * trackBytes) != (ssize_t)trackBytes) {
+            warn("Track %d: Cannot write to %s\n", t, mappingPath.c_str());
+            result = false;
+            continue;
+        }
+        
+        dirty[t] = false;
+        bytes += trackBytes;
+    }
+    
+    result &= close(fd) == 0;
+    debug(DSK_DEBUG, "Flushed %zu bytes\n", bytes);
+    
+    if (result) modified = false;
     return result;
 }
 
+void
+Disk::encodeAllTracks()
+{
+    for (Track t = 0; t < maxTracks; t++) {
+        prepareTrack(t);
+    }
+}
+
 bool
-Disk::encodeTrack(ADFFile *adf, Track t, long smax)
+Disk::encodeTrack(Track t)
 {
-    assert(isValidTrack(t));
+    assert(t >= 0 && t < maxTracks);
  
     bool result = true;
+    long smax = numSectors();
     
     debug(2, "Encoding track %d\n", t);
     
     // Remove previously written data
     clearTrack(t);
+    encoded[t] = true;
+    
+    // Tracks without sector data remain empty
+    checkMapping();
+    if (t >= numTracks() || sectors == NULL) return true;
     
     // Encode each sector
     for (Sector s = 0; s < smax; s++) {
-        result &= encodeSector(adf, t, s);
+        result &= encodeSector(t, s);
     }
     
     // Get the clock bit right at offset position 0
@@ -190,7 +465,7 @@ Disk::encodeTrack(ADFFile *adf, Track t, long smax)
     p[4] = 0xAA;
     */
     
-     if (1) {
+     if (debugLevel >= 2) {
  
          uint8_t *p = data.track[t] + (0 * sectorSize);
          
@@ -212,7 +487,7 @@ Disk::encodeTrack(ADFFile *adf, Track t, long smax)
 }
 
 bool
-Disk::encodeSector(ADFFile *adf, Track t, Sector s)
+Disk::encodeSector(Track t, Sector s)
 {
     assert(isValidTrack(t));
     assert(isValidSector(s));
@@ -253,41 +528,52 @@ Disk::encodeSector(ADFFile *adf, Track t, Sector s)
     p[i] = 0xAA;
     
     // Data
-    uint8_t bytes[512];
-    adf->readSector(bytes, t, s);
-    encodeOddEven(&p[64], bytes, sizeof(bytes));
+    uint8_t *bytes = sectors + (t * numSectors() + s) * 512;
+    encodeOddEven(&p[64], bytes, 512);
     
     // Block checksum
-    uint8_t bcheck[4] = { 0, 0, 0, 0 };
-    for(unsigned i = 8; i < 48; i += 4) {
-        bcheck[0] ^= p[i];
-        bcheck[1] ^= p[i+1];
-        bcheck[2] ^= p[i+2];
-        bcheck[3] ^= p[i+3];
-    }
+    uint8_t bcheck[4];
+    computeChecksum(bcheck, &p[8], 40);
     encodeOddEven(&p[48], bcheck, sizeof(bcheck));
     
     // Data checksum
-    uint8_t dcheck[4] = { 0, 0, 0, 0 };
-    for(unsigned i = 64; i < 1088; i += 4) {
-        dcheck[0] ^= p[i];
-        dcheck[1] ^= p[i+1];
-        dcheck[2] ^= p[i+2];
-        dcheck[3] ^= p[i+3];
-    }
-    encodeOddEven(&p[56], dcheck, sizeof(bcheck));
+    uint8_t dcheck[4];
+    computeChecksum(dcheck, &p[64], 1024);
+    encodeOddEven(&p[56], dcheck, sizeof(dcheck));
     
     // Add clock bits
+#ifdef __SSSE3__
+    addClockBitsSSE(&p[8], 1080);
+#else
     for(unsigned i = 8; i < 1088; i ++) {
         p[i] = addClockBits(p[i], p[i-1]);
     }
+#endif
     
     return true;
 }
 
+void
+Disk::computeChecksum(uint8_t *check, const uint8_t *source, size_t count)
+{
+    assert(count % 4 == 0);
+    
+    // XOR all long words (the byte order doesn't matter here)
+    uint32_t result = 0;
+    for (size_t i = 0; i < count; i += 4) {
+        uint32_t word;
+        memcpy(&word, source + i, 4);
+        result ^= word;
+    }
+    memcpy(check, &result, 4);
+}
+
 void
 Disk::encodeOddEven(uint8_t *target, uint8_t *source, size_t count)
 {
+#ifdef __SSSE3__
+    encodeOddEvenSSE(target, source, count);
+#else
     // Encode odd bits
     for(size_t i = 0; i < count; i++)
         target[i] = (source[i] >> 1) & 0x55;
@@ -295,6 +581,7 @@ Disk::encodeOddEven(uint8_t *target, uint8_t *source, size_t count)
     // Encode even bits
     for(size_t i = 0; i < count; i++)
         target[i + count] = source[i] & 0x55;
+#endif
 }
 
 bool
@@ -305,16 +592,24 @@ Disk::decodeDisk(uint8_t *dst)
     long smax = numSectors();
     
     debug("Decoding disk (%d tracks, %d sectors each)...\n", tmax, smax);
+    checkMapping();
     
     for (Track t = 0; t < tmax; t++) {
-        result &= decodeTrack(dst, t, smax);
+        
+        // Unmodified tracks are taken from the sector data
+        if (!dirty[t] && sectors) {
+            memcpy(dst, sectors + t * smax * 512, smax * 512);
+        } else {
+            prepareTrack(t);
+            result &= decodeTrack(dst, t, smax);
+        }
         dst += smax * 512;
     }
     
     return result;
 }
 
-size_t
+bool
 Disk::decodeTrack(uint8_t *dst, Track t, long smax)
 {
     assert(isValidTrack(t));
@@ -326,49 +621,94 @@ Disk::decodeTrack(uint8_t *dst, Track t, long smax)
     memcpy(local, data.track[t], trackSize);
     memcpy(local + trackSize, data.track[t], trackSize);
     
+    // Decode into a separate buffer to leave dst untouched on errors
+    assert(smax <= maxSectors);
+    uint8_t buffer[maxSectors * 512];
+    bool found[maxSectors];
+    long nr = 0;
+    for (Sector s = 0; s < smax; s++) found[s] = false;
+    
     // Seek all sync marks
-    int sectorStart[smax], index = 0, nr = 0;
-    while (index < trackSize + sectorSize && nr < smax) {
+    int index = 0;
+    while (index < trackSize) {
 
+#ifdef __SSSE3__
+        // Skip everything up to the next sync mark
+        const uint8_t *next = findSyncMarkSSE(local + index, local + trackSize);
+        if (next == NULL) break;
+        index = (int)(next - local);
+#endif
+        
         if (local[index++] != 0x44) continue;
         if (local[index++] != 0x89) continue;
         if (local[index++] != 0x44) continue;
         if (local[index++] != 0x89) continue;
         
-        sectorStart[nr++] = index;
-        // debug("   Sector %d starts at index %d\n", nr-1, sectorStart[nr-1]);
+        // Place the sector according to the sector number in its header
+        Sector s = decodeSector(buffer, local + index, t);
+        if (s < 0) {
+            warn("Track %d: Corrupted sector at offset %d. Aborting.\n", t, index);
+            return false;
+        }
+        if (found[s]) {
+            warn("Track %d: Sector %d found twice. Aborting.\n", t, s);
+            return false;
+        }
+        found[s] = true;
+        nr++;
     }
     
     if (nr != smax) {
-        warn("Track %d: Found %d sectors, expected %d. Aborting.\n", t, nr, smax);
+        warn("Track %d: Found %ld sectors, expected %ld. Aborting.\n", t, nr, smax);
         return false;
     }
     
-    // Encode all sectors
-    for (Sector s = 0; s < smax; s++) {
-        decodeSector(dst, local + sectorStart[s]);
-        dst += 512;
-    }
-    
+    memcpy(dst, buffer, smax * 512);
     return true;
 }
 
-void
-Disk::decodeSector(uint8_t *dst, uint8_t *src)
+Sector
+Disk::decodeSector(uint8_t *dst, uint8_t *src, Track t)
 {
     assert(dst != NULL);
     assert(src != NULL);
 
-    // Skip sector header
-    src += 56;
+    /* Block header layout (relative to the end of the SYNC mark):
+     *                     Start  Size   Value
+     * Track & sector info 00      8     Odd/Even encoded
+     * Unused area         08     32     0xAA
+     * Block checksum      40      8     Odd/Even encoded
+     * Data checksum       48      8     Odd/Even encoded
+     * Data                56   1024     Odd/Even encoded
+     */
+    uint8_t info[4];
+    decodeOddEven(info, src, sizeof(info));
+    
+    Sector s = info[2];
+    if (info[0] != 0xFF || info[1] != t || !isValidSector(s)) return -1;
+    
+    // Verify the checksums (they only cover the data bits)
+    uint8_t bcheck[4], dcheck[4], check[4];
+    decodeOddEven(bcheck, src + 40, sizeof(bcheck));
+    decodeOddEven(dcheck, src + 48, sizeof(dcheck));
+    
+    computeChecksum(check, src, 40);
+    for (unsigned i = 0; i < 4; i++) if ((check[i] & 0x55) != bcheck[i]) return -1;
+    
+    computeChecksum(check, src + 56, 1024);
+    for (unsigned i = 0; i < 4; i++) if ((check[i] & 0x55) != dcheck[i]) return -1;
     
     // Decode sector data
-    decodeOddEven(dst, src, 512);
+    decodeOddEven(dst + s * 512, src + 56, 512);
+    return s;
 }
 
 void
 Disk::decodeOddEven(uint8_t *dst, uint8_t *src, size_t count)
 {
+#ifdef __SSSE3__
+    decodeOddEvenSSE(dst, src, count);
+#else
     // Decode odd bits
     for(size_t i = 0; i < count; i++)
         dst[i] = (src[i] & 0x55) << 1;
@@ -376,4 +716,5 @@ Disk::decodeOddEven(uint8_t *dst, uint8_t *src, size_t count)
     // Decode even bits
     for(size_t i = 0; i < count; i++)
         dst[i] |= src[i + count] & 0x55;
+#endif
 }
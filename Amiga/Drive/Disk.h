@@ -56,6 +56,8 @@ public:
     static const long trackSize    = 12668; // 12664;
     static const long cylinderSize = 2 * trackSize;
     static const long diskSize     = 80 * cylinderSize;
+    static const long maxTracks    = 160;
+    static const long maxSectors   = 22;
     
     // static const uint64_t MFM_DATA_BIT_MASK8  = 0x55;
     // static const uint64_t MFM_CLOCK_BIT_MASK8 = 0xAA;
@@ -73,6 +75,38 @@ public:
     bool writeProtected;
     bool modified;
     
+    /* Lazy MFM encoding
+     * When a disk is created from an ADF, only the sector data is stored.
+     * A track is MFM encoded when it is accessed for the first time. When the
+     * disk is converted back, only the tracks that have been written to are
+     * decoded. All other tracks are taken from the sector data.
+     */
+    vector<uint8_t> sectorData;
+    
+    /* The sector data of the ADF is accessed via this pointer. It either
+     * points into sectorData or, if the ADF has been read from a file, into
+     * a private memory-mapped version of this file. In the latter case,
+     * modified tracks can be written back by calling flush().
+     */
+    uint8_t *sectors = NULL;
+    
+    // The memory-mapped ADF (NULL if the sector data has been copied)
+    uint8_t *mapping = NULL;
+    size_t mappingSize = 0;
+    
+    // The mapped file (kept open to detect size changes)
+    int mappingFd = -1;
+    std::string mappingPath;
+    
+    // Indicates if flush() can write into the mapped file
+    bool mappingIsWritable = false;
+    
+    // Indicates which tracks have been MFM encoded
+    bool encoded[maxTracks];
+    
+    // Indicates which tracks have been written to
+    bool dirty[maxTracks];
+    
     //
     // Class functions
     //
@@ -91,6 +125,7 @@ public:
 public:
     
     Disk(DiskType type);
+    virtual ~Disk();
     
     // Factory methods
     static Disk *makeWithFile(ADFFile *file);
@@ -107,12 +142,25 @@ public:
         worker
 
         & type
-        & data.raw
         & writeProtected
-        & modified;
+        & modified
+        & encoded
+        & dirty;
     }
 
 
+    //
+    // Serializing
+    //
+
+    /* Snapshots store the sector data and the MFM data of all encoded tracks.
+     * Tracks that have not been accessed yet are encoded on demand after the
+     * snapshot has been restored, as they are for a freshly inserted disk.
+     */
+    size_t serializedSize();
+    void serialize(SerWriter &writer);
+
+
     //
     // Getter and Setter
     //
@@ -156,6 +204,16 @@ public:
     // Writes a byte to disk
     void writeByte(uint8_t value, Cylinder cylinder, Side side, uint16_t offset);
 
+    // Reads or writes a block of bytes within a single track
+    void readBytes(uint8_t *dst, Cylinder cylinder, Side side, uint16_t offset, long count);
+    void writeBytes(const uint8_t *src, Cylinder cylinder, Side side, uint16_t offset, long count);
+
+    /* Searches a track for a 16-bit word, starting at the specified offset.
+     * The track is treated as a ring, i.e., the search wraps around at the
+     * end. Returns the offset of the first byte of the word or -1.
+     */
+    long findWord(uint16_t word, Cylinder cylinder, Side side, uint16_t offset);
+
     
     //
     // Handling MFM encoded data
@@ -179,15 +237,47 @@ public:
     // Clears a single track
     void clearTrack(Track t);
 
-    // Encodes the whole disk
+    /* Encodes the whole disk
+     * The sector data is taken over from the ADF and the tracks are encoded
+     * on demand when they are accessed for the first time.
+     */
     bool encodeDisk(ADFFile *adf);
     
+    // Encodes all tracks that have not been accessed yet
+    void encodeAllTracks();
+    
+    /* Writes all modified tracks back to the ADF the disk was created from.
+     * Only possible if the ADF has been read from a writable file. Returns
+     * true if all modified tracks could be decoded and written.
+     */
+    bool flush();
+    
+    // Indicates if flush() can write to the ADF the disk was created from
+    bool canFlush() { return mappingIsWritable; }
+    
 private:
     
+    // Uses a file as sector data source without copying it
+    bool mapFile(const char *path, size_t size);
+    
+    // Frees the sector data
+    void releaseSectors();
+    
+    /* Copies the sector data if the size of the mapped file has changed.
+     * Accessing a mapped page beyond the end of a truncated file would
+     * raise SIGBUS. Must be called before reading the sector data.
+     */
+    void checkMapping();
+    
+    
+    // Makes sure that a track has been MFM encoded
+    void prepareTrack(Track t) { if (!encoded[t]) encodeTrack(t); }
+    
     // Work horses
-    bool encodeTrack(ADFFile *adf, Track t, long smax);
-    bool encodeSector(ADFFile *adf, Track t, Sector s);
+    bool encodeTrack(Track t);
+    bool encodeSector(Track t, Sector s);
     void encodeOddEven(uint8_t *target, uint8_t *source, size_t count);
+    void computeChecksum(uint8_t *check, const uint8_t *source, size_t count);
     
     
     //
@@ -201,9 +291,14 @@ public:
     
 private:
     
-    // Work horses
-    size_t decodeTrack(uint8_t *dst, Track t, long smax);
-    void decodeSector(uint8_t *dst, uint8_t *src);
+    /* Work horses
+     * decodeTrack() only writes to dst if all sectors have been found and
+     * their checksums match. decodeSector() verifies a single sector and
+     * stores it at the position given by its sector number, which is
+     * returned (-1 if the sector is corrupted).
+     */
+    bool decodeTrack(uint8_t *dst, Track t, long smax);
+    Sector decodeSector(uint8_t *dst, uint8_t *src, Track t);
     void decodeOddEven(uint8_t *dst, uint8_t *src, size_t count);
 };
 
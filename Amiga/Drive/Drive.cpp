@@ -74,7 +74,7 @@ Drive::_size()
 
         // Add the disk type and disk state
         counter & disk->getType();
-        disk->applyToPersistentItems(counter);
+        counter.count += disk->serializedSize();
     }
 
     return counter.count;
@@ -126,7 +126,7 @@ Drive::_save(uint8_t *buffer)
         writer & disk->getType();
 
         // Write the disk's state
-        disk->applyToPersistentItems(writer);
+        disk->serialize(writer);
     }
 
     debug(SNAP_DEBUG, "Serialized to %d bytes\n", writer.ptr - buffer);
@@ -309,6 +309,26 @@ Drive::readHead16()
     return HI_LO(byte1, byte2);
 }
 
+void
+Drive::readHead(uint8_t *dst, long count)
+{
+    while (count > 0) {
+
+        // Read up to the end of the current track
+        long chunk = MIN(count, Disk::trackSize - head.offset);
+
+        if (disk) {
+            disk->readBytes(dst, head.cylinder, head.side, head.offset, chunk);
+        } else {
+            memset(dst, 0xFF, chunk);
+        }
+        rotate(chunk);
+
+        dst += chunk;
+        count -= chunk;
+    }
+}
+
 void
 Drive::writeHead(uint8_t value)
 {
@@ -325,6 +345,24 @@ Drive::writeHead16(uint16_t value)
     writeHead(LO_BYTE(value));
 }
 
+void
+Drive::writeHead(const uint8_t *src, long count)
+{
+    while (count > 0) {
+
+        // Write up to the end of the current track
+        long chunk = MIN(count, Disk::trackSize - head.offset);
+
+        if (disk) {
+            disk->writeBytes(src, head.cylinder, head.side, head.offset, chunk);
+        }
+        rotate(chunk);
+
+        src += chunk;
+        count -= chunk;
+    }
+}
+
 void
 Drive::rotate()
 {
@@ -347,13 +385,35 @@ Drive::rotate()
 }
 
 void
-Drive::findSyncMark()
+Drive::rotate(long count)
 {
-    for (unsigned i = 0; i < disk->trackSize; i++) {
-        
-        if (readHead() != 0x44) continue;
-        if (readHead() != 0x89) continue;
-        break;
+    assert(count >= 0);
+
+    long offset = head.offset + count;
+
+    // Emulate an index pulse each time the head passes the track start
+    while (offset >= Disk::trackSize) {
+
+        offset -= Disk::trackSize;
+        if (isSelected()) ciab.emulateFallingEdgeOnFlagPin();
+    }
+    head.offset = (uint16_t)offset;
+}
+
+void
+Drive::findSyncMark(uint16_t sync)
+{
+    long pos = disk ? disk->findWord(sync, head.cylinder, head.side, head.offset) : -1;
+
+    if (pos < 0) {
+
+        // No sync mark on this track. Give up after a full revolution
+        rotate(Disk::trackSize);
+
+    } else {
+
+        // Move the head to the byte following the sync mark
+        rotate((pos - head.offset + Disk::trackSize) % Disk::trackSize + 2);
     }
 
     debug(DSK_DEBUG, "Moving to SYNC mark at offset %d\n", head.offset);
@@ -475,6 +535,11 @@ Drive::ejectDisk()
         // Flag disk change in the CIAA::PA
         dskchange = false;
         
+        // Write back all modified tracks
+        if (amiga.paula.diskController.getConfig().writeBack && disk->isModified()) {
+            disk->flush();
+        }
+        
         // Get rid of the disk
         delete disk;
         disk = NULL;
@@ -215,16 +215,21 @@ public:
     // Reads a value from the drive head and rotates the disk.
     uint8_t readHead();
     uint16_t readHead16();
-    
+    void readHead(uint8_t *dst, long count);
+
     // Writes a value to the drive head and rotates the disk.
     void writeHead(uint8_t value);
     void writeHead16(uint16_t value);
+    void writeHead(const uint8_t *src, long count);
 
     // Emulate a disk rotation (moves head to the next byte).
     void rotate();
 
-    // Rotates the disk to the next sync mark.
-    void findSyncMark();
+    // Moves the head forward by multiple bytes at once.
+    void rotate(long count);
+
+    // Rotates the disk to the byte following the next sync mark.
+    void findSyncMark(uint16_t sync);
 
     //
     // Moving the drive head
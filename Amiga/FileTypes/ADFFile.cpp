@@ -16,7 +16,7 @@ ADFFile::ADFFile()
 }
 
 bool
-ADFFile::isADFBuffer(const uint8_t *buffer, size_t length)
+ADFFile::isADFBuffer(const uint8_t *, size_t length)
 {
     // There are no magic bytes. We can only check the buffer size.
     return
@@ -89,7 +89,7 @@ ADFFile::makeWithFile(const char *path)
 {
     ADFFile *adf = new ADFFile();
     
-    if (!adf->readFromFile(path)) {
+    if (!adf->mapFile(path)) {
         delete adf;
         return NULL;
     }
@@ -152,6 +152,8 @@ ADFFile::getNumSectorsPerTrack()
         case DISK_525_SD:
         return 9;
     }
+    assert(0);
+    return 0;
 }
 
 long
@@ -266,7 +268,7 @@ ADFFile::writeRootBlock(const char *label)
     // Volume name as a BCPL string (first byte is string length)
     size_t len = strlen(label);
     p[432] = (len > 30) ? 30 : len;
-    strncpy((char *)(p + 433), label, len);
+    memcpy(p + 433, label, p[432]);
     p[463] = 0;
     
     // Secondary type indicates root block
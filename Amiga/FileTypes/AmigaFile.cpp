@@ -9,6 +9,9 @@
 
 #include "AmigaFile.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+
 AmigaFile::AmigaFile()
 {
 }
@@ -43,7 +46,12 @@ AmigaFile::dealloc()
         return;
     }
     
-    delete[] data;
+    if (mapped) {
+        munmap(data, size);
+        mapped = false;
+    } else {
+        delete[] data;
+    }
     data = NULL;
     
     size = 0;
@@ -73,7 +81,7 @@ AmigaFile::read()
 {
     int result;
     
-    assert(eof <= size);
+    assert(eof <= (long)size);
     
     if (fp < 0)
         return -1;
@@ -128,8 +136,8 @@ AmigaFile::readFromFile(const char *filename)
     assert (filename != NULL);
     
     bool success = false;
-    uint8_t *buffer = NULL;
-    FILE *file = NULL;
+    void *buffer = MAP_FAILED;
+    int fd = -1;
     struct stat fileProperties;
     
     // Check file type
@@ -137,47 +145,97 @@ AmigaFile::readFromFile(const char *filename)
         goto exit;
     }
     
+    // Open file
+    if ((fd = open(filename, O_RDONLY)) < 0) {
+        goto exit;
+    }
+    
     // Get file properties
-    if (stat(filename, &fileProperties) != 0) {
+    if (fstat(fd, &fileProperties) != 0 || fileProperties.st_size == 0) {
+        goto exit;
+    }
+    
+    // Map the file into memory
+    buffer = mmap(NULL, fileProperties.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (buffer == MAP_FAILED) {
+        goto exit;
+    }
+    
+    // Read from buffer
+    dealloc();
+    if (!readFromBuffer((uint8_t *)buffer, (size_t)fileProperties.st_size)) {
+        goto exit;
+    }
+    
+    setPath(filename);
+    success = true;
+    
+    debug(1, "File %s read successfully\n", path);
+    
+exit:
+    
+    if (buffer != MAP_FAILED)
+        munmap(buffer, fileProperties.st_size);
+    if (fd >= 0)
+        close(fd);
+    
+    return success;
+}
+
+bool
+AmigaFile::mapFile(const char *filename)
+{
+    assert (filename != NULL);
+    
+    bool success = false;
+    void *buffer = MAP_FAILED;
+    int fd = -1;
+    struct stat fileProperties;
+    
+    // Check file type
+    if (!fileHasSameType(filename)) {
         goto exit;
     }
     
     // Open file
-    if (!(file = fopen(filename, "r"))) {
+    if ((fd = open(filename, O_RDONLY)) < 0) {
         goto exit;
     }
     
-    // Allocate memory
-    if (!(buffer = new uint8_t[fileProperties.st_size])) {
+    // Get file properties
+    if (fstat(fd, &fileProperties) != 0 || fileProperties.st_size == 0) {
         goto exit;
     }
     
-    // Read from file
-    int c;
-    for (unsigned i = 0; i < fileProperties.st_size; i++) {
-        c = fgetc(file);
-        if (c == EOF)
-            break;
-        buffer[i] = (uint8_t)c;
+    // Map the file into memory (copy on write)
+    buffer = mmap(NULL, fileProperties.st_size,
+                  PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (buffer == MAP_FAILED) {
+        goto exit;
     }
     
-    // Read from buffer
-    dealloc();
-    if (!readFromBuffer(buffer, (unsigned)fileProperties.st_size)) {
+    // Check the contents
+    if (!bufferHasSameType((uint8_t *)buffer, (size_t)fileProperties.st_size)) {
+        munmap(buffer, fileProperties.st_size);
         goto exit;
     }
     
+    // Use the mapped file as data buffer
+    dealloc();
+    data = (uint8_t *)buffer;
+    size = eof = fileProperties.st_size;
+    fp = 0;
+    mapped = true;
+    
     setPath(filename);
     success = true;
     
-    debug(1, "File %s read successfully\n", path);
+    debug(1, "File %s mapped successfully\n", path);
     
 exit:
     
-    if (file)
-        fclose(file);
-    if (buffer)
-        delete[] buffer;
+    if (fd >= 0)
+        close(fd);
     
     return success;
 }
@@ -28,6 +28,9 @@ protected:
     // The size of this file in bytes
     size_t size = 0;
     
+    // Indicates if the raw data is a memory-mapped file
+    bool mapped = false;
+    
     /* File pointer
      * An offset into the data array with -1 indicating EOF
      */
@@ -81,6 +84,9 @@ public:
     //  Returns the number of bytes in this file.
     virtual size_t getSize() { return size; }
     
+    // Returns a pointer to the raw data
+    const uint8_t *getData() { return data; }
+    
     // Moves the file pointer to the specified offset.
     virtual void seek(long offset);
     
@@ -108,13 +114,13 @@ public:
     /* Returns true iff this specified buffer is compatible with this object.
      * This function is used in readFromBuffer().
      */
-    virtual bool bufferHasSameType(const uint8_t *buffer, size_t length) { return false; }
+    virtual bool bufferHasSameType(const uint8_t *, size_t ) { return false; }
 
 
     /* Returns true iff this specified file is compatible with this object.
      * This function is used in readFromFile().
      */
-    virtual bool fileHasSameType(const char *path) { return false; }
+    virtual bool fileHasSameType(const char *) { return false; }
     
     /* Deserializes this object from a memory buffer.
      *   - buffer   The address of a binary representation in memory.
@@ -133,6 +139,13 @@ public:
      */
     bool readFromFile(const char *filename);
     
+    /* Maps a file into memory instead of reading it in.
+     * The data is not copied. Pages are loaded on demand when they are
+     * accessed. The mapping is private, i.e., modifying the data does not
+     * alter the file. The buffer is checked with bufferHasSameType().
+     */
+    bool mapFile(const char *filename);
+    
     /* Writes the file contents into a memory buffer.
      * If a NULL pointer is passed in, a test run is performed. Test runs can
      * be performed to determine the size of the file on disk.
@@ -144,7 +157,7 @@ public:
      * first and writes the data to disk afterwards.
      *   - filename   The name of a file to be written.
      */
-    bool writeToFile(const char *filename);
+    virtual bool writeToFile(const char *filename);
 };
 
 #endif
@@ -8,6 +8,95 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "lz_utils.h"
+
+#include <fcntl.h>
+
+// Signature of compressed snapshots
+static const uint8_t compressedSignature[] = { 'V', 'A', 'S', 'N', 'P', 'Z' };
+
+// Preferred uncompressed size of a chunk in compressed snapshots
+static const size_t chunkSize = 256 * 1024;
+
+/* Assembles the chunks of a compressed snapshot.
+ * Small pieces of data are collected until a chunk of reasonable size is
+ * available. The compressed chunks are handed over to an output function.
+ */
+class ChunkWriter {
+
+    std::function<bool(const uint8_t *, size_t)> output;
+    vector<uint8_t> pending;
+    vector<uint8_t> buffer;
+
+public:
+
+    ChunkWriter(std::function<bool(const uint8_t *, size_t)> f) : output(f) { }
+
+    // Adds data to the current chunk
+    bool add(const uint8_t *data, size_t size)
+    {
+        pending.insert(pending.end(), data, data + size);
+        return pending.size() < chunkSize ? true : flush();
+    }
+
+    // Compresses and writes the current chunk
+    bool flush()
+    {
+        if (pending.empty()) return true;
+
+        buffer.resize(8 + lzBound(pending.size()));
+        uint8_t *ptr = buffer.data();
+        size_t size = lzCompress(pending.data(), pending.size(), ptr + 8);
+        write32(ptr, (uint32_t)pending.size());
+        write32(ptr, (uint32_t)size);
+        pending.clear();
+
+        return output(buffer.data(), 8 + size);
+    }
+
+    // Writes the remaining data and the end marker
+    bool finish()
+    {
+        uint8_t marker[8] = { 0 };
+        return flush() && output(marker, sizeof(marker));
+    }
+};
+
+static bool
+writeFully(int fd, const uint8_t *buffer, size_t length)
+{
+    while (length) {
+
+        ssize_t written = write(fd, buffer, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        buffer += written;
+        length -= written;
+    }
+    return true;
+}
+
+/* Walks through the chunks of a compressed snapshot.
+ * Returns the accumulated uncompressed size or 0 if the data is malformed.
+ */
+static size_t
+checkChunks(const uint8_t *ptr, const uint8_t *end)
+{
+    size_t total = 0;
+
+    while (end - ptr >= 8) {
+
+        uint32_t size = read32((uint8_t *&)ptr);
+        uint32_t packedSize = read32((uint8_t *&)ptr);
+
+        if (size == 0) return packedSize == 0 ? total : 0;
+        if (packedSize > (size_t)(end - ptr)) return 0;
+
+        ptr += packedSize;
+        total += size;
+    }
+    return 0;
+}
 
 bool
 Snapshot::isSnapshot(const uint8_t *buffer, size_t length)
@@ -16,10 +105,20 @@ Snapshot::isSnapshot(const uint8_t *buffer, size_t length)
     
     assert(buffer != NULL);
     
+    if (isCompressedSnapshot(buffer, length)) return true;
     if (length < sizeof(SnapshotHeader)) return false;
     return matchingBufferHeader(buffer, signature, sizeof(signature));
 }
 
+bool
+Snapshot::isCompressedSnapshot(const uint8_t *buffer, size_t length)
+{
+    assert(buffer != NULL);
+
+    if (length < sizeof(compressedSignature) + 3) return false;
+    return matchingBufferHeader(buffer, compressedSignature, sizeof(compressedSignature));
+}
+
 bool
 Snapshot::isSnapshot(const uint8_t *buffer, size_t length,
                           uint8_t major, uint8_t minor, uint8_t subminor)
@@ -47,17 +146,22 @@ Snapshot::isSnapshotFile(const char *path)
     
     assert(path != NULL);
     
-    return matchingFileHeader(path, signature, sizeof(signature));
+    return
+    matchingFileHeader(path, signature, sizeof(signature)) ||
+    matchingFileHeader(path, compressedSignature, sizeof(compressedSignature));
 }
 
 bool
 Snapshot::isSnapshotFile(const char *path, uint8_t major, uint8_t minor, uint8_t subminor)
 {
-    uint8_t signature[] = { 'V', 'C', '6', '4', major, minor, subminor };
+    uint8_t signature[] = { 'V', 'A', 'S', 'N', 'A', 'P', major, minor, subminor };
+    uint8_t compressed[] = { 'V', 'A', 'S', 'N', 'P', 'Z', major, minor, subminor };
     
     assert(path != NULL);
     
-    return matchingFileHeader(path, signature, sizeof(signature));
+    return
+    matchingFileHeader(path, signature, sizeof(signature)) ||
+    matchingFileHeader(path, compressed, sizeof(compressed));
 }
 
 bool
@@ -139,6 +243,196 @@ Snapshot::makeWithAmiga(Amiga *amiga)
     return snapshot;
 }
 
+bool
+Snapshot::writeCompressed(int fd)
+{
+    return writeChunks([fd](const uint8_t *buffer, size_t length) {
+        return writeFully(fd, buffer, length);
+    });
+}
+
+bool
+Snapshot::writeCompressed(vector<uint8_t> &buffer)
+{
+    buffer.clear();
+    return writeChunks([&buffer](const uint8_t *data, size_t length) {
+        buffer.insert(buffer.end(), data, data + length);
+        return true;
+    });
+}
+
+bool
+Snapshot::makeDelta(SnapshotImage image, SnapshotImage &base)
+{
+    size_t coreSize = image->size();
+
+    pageOffsets.clear();
+    pages.clear();
+
+    if (base && base->size() == coreSize) {
+
+        uint8_t *oldData = base->data();
+        uint8_t *newData = image->data();
+
+        // Collect all pages that differ from the base image
+        for (size_t offset = 0; offset < coreSize; offset += PAGE_SIZE) {
+
+            size_t len = MIN(PAGE_SIZE, coreSize - offset);
+            if (memcmp(oldData + offset, newData + offset, len) != 0) {
+                pageOffsets.push_back((uint32_t)offset);
+                pages.insert(pages.end(), newData + offset, newData + offset + len);
+            }
+        }
+
+        // Keep the delta if it is small enough
+        if (pages.size() <= coreSize / 4) {
+            this->base = base;
+            return false;
+        }
+
+        pageOffsets.clear();
+        pages.clear();
+    }
+
+    // Make the core data image the new base image
+    base = image;
+    this->base = base;
+    return true;
+}
+
+size_t
+Snapshot::coreSize()
+{
+    if (isExpanded()) return size - sizeof(SnapshotHeader);
+    if (isDelta()) return base->size();
+    return checkChunks(packed.data(), packed.data() + packed.size());
+}
+
+uint8_t *
+Snapshot::expand(vector<uint8_t> &buffer)
+{
+    if (isExpanded()) return getData();
+    if (isDelta() && pageOffsets.empty()) return base->data();
+
+    size_t coreSize = this->coreSize();
+    buffer.resize(coreSize);
+    uint8_t *core = buffer.data();
+
+    if (isDelta()) {
+
+        // Copy the base image and apply all changed pages
+        memcpy(core, base->data(), coreSize);
+
+        uint8_t *page = pages.data();
+        for (uint32_t offset : pageOffsets) {
+
+            size_t len = MIN(PAGE_SIZE, coreSize - offset);
+            memcpy(core + offset, page, len);
+            page += len;
+        }
+
+    } else {
+
+        // Decompress all chunks
+        uint8_t *ptr = packed.data();
+        for (uint8_t *dst = core; dst < core + coreSize; ) {
+
+            uint32_t size = read32(ptr);
+            uint32_t packedSize = read32(ptr);
+
+            if (!lzDecompress(ptr, packedSize, dst, size)) {
+                warn("Corrupted snapshot data\n");
+                return NULL;
+            }
+            ptr += packedSize;
+            dst += size;
+        }
+    }
+
+    return core;
+}
+
+bool
+Snapshot::readFromBuffer(const uint8_t *buffer, size_t length)
+{
+    if (!isCompressedSnapshot(buffer, length)) {
+        return AmigaFile::readFromBuffer(buffer, length);
+    }
+
+    const uint8_t *ptr = buffer + sizeof(compressedSignature) + 3;
+    const uint8_t *end = buffer + length;
+
+    // Check the chunk structure
+    if (checkChunks(ptr, end) <= sizeof(SnapshotHeader)) return false;
+
+    // Decompress the header
+    uint32_t headerSize = read32((uint8_t *&)ptr);
+    uint32_t packedSize = read32((uint8_t *&)ptr);
+    if (headerSize != sizeof(SnapshotHeader) || !alloc(headerSize)) return false;
+    if (!lzDecompress(ptr, packedSize, data, headerSize)) return false;
+    ptr += packedSize;
+
+    // Keep the core data in compressed form
+    packed.assign(ptr, end);
+
+    return true;
+}
+
+size_t
+Snapshot::writeToBuffer(uint8_t *buffer)
+{
+    size_t count = 0;
+
+    bool success = writeChunks([buffer, &count](const uint8_t *data, size_t length) {
+        if (buffer) memcpy(buffer + count, data, length);
+        count += length;
+        return true;
+    });
+
+    return success ? count : 0;
+}
+
+bool
+Snapshot::writeToFile(const char *filename)
+{
+    assert(filename != NULL);
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    bool success = writeCompressed(fd);
+    return (close(fd) == 0) && success;
+}
+
+bool
+Snapshot::writeChunks(std::function<bool(const uint8_t *, size_t)> output)
+{
+    ChunkWriter writer(output);
+
+    // Write the signature and the version number
+    uint8_t signature[] = { 'V', 'A', 'S', 'N', 'P', 'Z', V_MAJOR, V_MINOR, V_SUBMINOR };
+    if (!output(signature, sizeof(signature))) return false;
+
+    // Write the header in a separate chunk
+    if (!writer.add(data, sizeof(SnapshotHeader)) || !writer.flush()) return false;
+
+    // Compressed core data is written as it is (including the end marker)
+    if (!isDelta() && !packed.empty()) {
+        return output(packed.data(), packed.size());
+    }
+
+    vector<uint8_t> buffer;
+    uint8_t *core = expand(buffer);
+    if (!core) return false;
+
+    // Write the core data
+    size_t coreSize = this->coreSize();
+    for (size_t offset = 0; offset < coreSize; offset += chunkSize) {
+        if (!writer.add(core + offset, MIN(chunkSize, coreSize - offset))) return false;
+    }
+    return writer.finish();
+}
+
 bool
 Snapshot::bufferHasSameType(const uint8_t* buffer, size_t length)
 {
@@ -12,8 +12,16 @@
 
 #include "AmigaFile.h"
 
+#include <memory>
+#include <functional>
+
+using std::shared_ptr;
+
 class Amiga;
 
+// Core data image shared by multiple delta snapshots
+typedef shared_ptr<vector<uint8_t>> SnapshotImage;
+
 // Snapshot header
 typedef struct {
     
@@ -42,6 +50,33 @@ typedef struct {
 } SnapshotHeader;
 
 class Snapshot : public AmigaFile {
+
+    /* Delta compression
+     * Auto-snapshots are stored as deltas. The data buffer of a delta snapshot
+     * only contains the header. The core data is given by a base image, which
+     * is shared with other snapshots, and a list of all pages that differ
+     * from it. The original core data is reconstructed by calling expand().
+     */
+    static const size_t PAGE_SIZE = 4096;
+
+    // The base image (NULL if this snapshot is not a delta)
+    SnapshotImage base;
+
+    // Offsets and contents of all pages that differ from the base image
+    vector<uint32_t> pageOffsets;
+    vector<uint8_t> pages;
+
+    /* Compressed snapshots
+     * Snapshot files are stored in a compressed format. It starts with a
+     * signature ('V','A','S','N','P','Z') and the version number, followed
+     * by a sequence of chunks and an empty end marker. Each chunk stores the
+     * uncompressed size, the compressed size, and the compressed data. The
+     * first chunk contains the header and the others contain the core data.
+     * When a compressed snapshot is read, only the header is decompressed.
+     * The core data is kept in compressed form and only decompressed by
+     * expand().
+     */
+    vector<uint8_t> packed;
  
     //
     // Class methods
@@ -51,6 +86,9 @@ public:
     
     // Returns true iff buffer contains a snapshot.
     static bool isSnapshot(const uint8_t *buffer, size_t length);
+
+    // Returns true iff buffer contains a snapshot in compressed format.
+    static bool isCompressedSnapshot(const uint8_t *buffer, size_t length);
     
     // Returns true iff buffer contains a snapshot of a specific version.
     static bool isSnapshot(const uint8_t *buffer, size_t length,
@@ -90,6 +128,30 @@ public:
     static Snapshot *makeWithFile(const char *filename);
     static Snapshot *makeWithBuffer(const uint8_t *buffer, size_t size);
     static Snapshot *makeWithAmiga(Amiga *amiga);
+
+    // Writes this snapshot to a file descriptor in compressed format
+    bool writeCompressed(int fd);
+
+    /* Writes this snapshot in compressed format into a memory buffer.
+     * Determining the size with sizeOnDisk() requires a compression pass of
+     * its own. Use this function to compress the snapshot only once.
+     */
+    bool writeCompressed(vector<uint8_t> &buffer);
+
+    /* Turns a header-only snapshot into a delta snapshot.
+     * The delta is computed between the specified core data image and a base
+     * image. If no base image is given or if too many pages have changed, the
+     * core data image becomes the new base image. In this case, the function
+     * returns true.
+     */
+    bool makeDelta(SnapshotImage image, SnapshotImage &base);
+
+private:
+
+    // Emits this snapshot in compressed format
+    bool writeChunks(std::function<bool(const uint8_t *, size_t)> output);
+    
+public:
     
     
     //
@@ -100,6 +162,9 @@ public:
     const char *typeAsString() override { return "VAMIGA"; }
     bool bufferHasSameType(const uint8_t *buffer, size_t length) override;
     bool fileHasSameType(const char *filename) override;
+    bool readFromBuffer(const uint8_t *buffer, size_t length) override;
+    size_t writeToBuffer(uint8_t *buffer) override;
+    bool writeToFile(const char *filename) override;
     
     
     //
@@ -112,7 +177,29 @@ public:
     SnapshotHeader *getHeader() { return (SnapshotHeader *)data; }
     
     // Returns pointer to core data
-    uint8_t *getData() { return data + sizeof(SnapshotHeader); }
+    uint8_t *getData() { assert(isExpanded()); return data + sizeof(SnapshotHeader); }
+
+    // Indicates if this snapshot is stored as a delta
+    bool isDelta() { return base != NULL; }
+
+    // Returns the number of bytes occupied by the delta (0 if no delta)
+    size_t deltaSize() { return pages.size(); }
+
+    // Returns the base image (NULL if this snapshot is not a delta)
+    SnapshotImage getBase() { return base; }
+
+    // Indicates if the core data is directly accessible via getData()
+    bool isExpanded() { return !isDelta() && packed.empty(); }
+
+    // Returns the size of the core data (0 if the compressed data is malformed)
+    size_t coreSize();
+
+    /* Returns a pointer to the core data
+     * If the snapshot is stored as a delta or in compressed form, the core
+     * data is reconstructed in the provided buffer. The snapshot itself is
+     * left untouched. Returns NULL if the compressed data is corrupted.
+     */
+    uint8_t *expand(vector<uint8_t> &buffer);
     
     // Returns the timestamp
     time_t getTimestamp() { return getHeader()->timestamp; }
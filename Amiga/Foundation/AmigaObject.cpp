@@ -45,46 +45,42 @@ AmigaObject::plainmsg(const char *fmt, ...) const
     VAPRINTPLAIN("")
 }
 
+#ifndef NDEBUG
+
 void
 AmigaObject::debug(const char *fmt, ...) const
 {
-#ifndef NDEBUG
     VAOBJ_PARSE
     VAPRINT("")
-#endif
 }
 
 void
 AmigaObject::debug(int level, const char *fmt, ...) const
 {
-#ifndef NDEBUG
-    if (level <= debugLevel) {
+    if (level <= (int)debugLevel) {
         VAOBJ_PARSE
         VAPRINT("")
     }
-#endif
 }
 
 void
 AmigaObject::plaindebug(const char *fmt, ...) const
 {
-#ifndef NDEBUG
     VAOBJ_PARSE
     VAPRINTPLAIN("")
-#endif
 }
 
 void
 AmigaObject::plaindebug(int level, const char *fmt, ...) const
 {
-#ifndef NDEBUG
-    if (level <= debugLevel) {
+    if (level <= (int)debugLevel) {
         VAOBJ_PARSE
         VAPRINTPLAIN("")
     }
-#endif
 }
 
+#endif
+
 void
 AmigaObject::warn(const char *fmt, ...) const
 {
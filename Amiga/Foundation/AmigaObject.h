@@ -74,10 +74,21 @@ class AmigaObject {
     void msg(const char *fmt, ...) const;
     void plainmsg(const char *fmt, ...) const;
     
+#ifndef NDEBUG
     void debug(const char *fmt, ...) const;
     void debug(int level, const char *fmt, ...) const;
     void plaindebug(const char *fmt, ...) const;
     void plaindebug(int level, const char *fmt, ...) const;
+#else
+    /* In release builds, debug messages compile to nothing. Defining the
+     * functions inline lets the compiler drop the calls entirely, which
+     * matters in hot paths such as the Copper's MOVE handler.
+     */
+    void debug(const char *, ...) const { }
+    void debug(int , const char *, ...) const { }
+    void plaindebug(const char *, ...) const { }
+    void plaindebug(int , const char *, ...) const { }
+#endif
     
     void warn(const char *fmt, ...) const;
     void panic(const char *fmt, ...) const;
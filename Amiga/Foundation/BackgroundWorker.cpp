@@ -0,0 +1,103 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "BackgroundWorker.h"
+
+BackgroundWorker::BackgroundWorker()
+{
+    setDescription("BackgroundWorker");
+
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+}
+
+BackgroundWorker::~BackgroundWorker()
+{
+    // Finish all pending jobs and terminate the thread
+    pthread_mutex_lock(&lock);
+    quit = true;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+
+    if (launched) pthread_join(thread, NULL);
+
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&lock);
+}
+
+void
+BackgroundWorker::dispatch(std::function<void()> job)
+{
+    pthread_mutex_lock(&lock);
+
+    if (!launched) {
+        launched = pthread_create(&thread, NULL, main, (void *)this) == 0;
+    }
+
+    if (launched) {
+        jobs.push_back(job);
+        pthread_cond_broadcast(&cond);
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    // Fall back to synchronous execution if no thread could be created
+    if (!launched) {
+        warn("Failed to launch the worker thread\n");
+        job();
+    }
+}
+
+void
+BackgroundWorker::waitUntilIdle()
+{
+    pthread_mutex_lock(&lock);
+
+    while (busy || !jobs.empty()) {
+        pthread_cond_wait(&cond, &lock);
+    }
+
+    pthread_mutex_unlock(&lock);
+}
+
+void *
+BackgroundWorker::main(void *worker)
+{
+    ((BackgroundWorker *)worker)->processJobs();
+    return NULL;
+}
+
+void
+BackgroundWorker::processJobs()
+{
+    pthread_mutex_lock(&lock);
+
+    while (1) {
+
+        // Wait for the next job
+        while (jobs.empty() && !quit) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        if (jobs.empty()) break;
+
+        std::function<void()> job = jobs.front();
+        jobs.pop_front();
+        busy = true;
+
+        // Execute the job with the lock released
+        pthread_mutex_unlock(&lock);
+        job();
+        pthread_mutex_lock(&lock);
+
+        busy = false;
+        pthread_cond_broadcast(&cond);
+    }
+
+    pthread_mutex_unlock(&lock);
+}
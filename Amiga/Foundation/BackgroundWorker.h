@@ -0,0 +1,59 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _BACKGROUND_WORKER_INC
+#define _BACKGROUND_WORKER_INC
+
+#include "AmigaObject.h"
+
+#include <deque>
+#include <functional>
+
+/* A thread for processing time-consuming tasks in the background.
+ * Jobs are executed one after another in the order they have been
+ * dispatched. The thread is launched when the first job arrives.
+ */
+class BackgroundWorker : public AmigaObject {
+
+    // The worker thread
+    pthread_t thread;
+    bool launched = false;
+
+    // Pending jobs
+    std::deque<std::function<void()>> jobs;
+
+    // Indicates if a job is being executed
+    bool busy = false;
+
+    // Indicates if the thread has been asked to terminate
+    bool quit = false;
+
+    // Synchronization primitives guarding the variables above
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+public:
+
+    BackgroundWorker();
+    ~BackgroundWorker();
+
+    // Adds a job to the end of the queue
+    void dispatch(std::function<void()> job);
+
+    // Blocks the calling thread until all pending jobs have been executed
+    void waitUntilIdle();
+
+private:
+
+    // The thread's main function
+    static void *main(void *worker);
+    void processJobs();
+};
+
+#endif
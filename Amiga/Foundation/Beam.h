@@ -27,12 +27,6 @@ struct Beam
     Beam(int16_t v, int16_t h) : v(v), h(h) { }
     Beam(uint32_t cycle = 0) : Beam(cycle / HPOS_CNT, cycle % HPOS_CNT) { }
 
-    Beam& operator=(const Beam& beam)
-    {
-        v = beam.v;
-        h = beam.h;
-        return *this;
-    }
 
     bool operator==(const Beam& beam) const
     {
@@ -230,7 +230,7 @@ HardwareComponent::load(uint8_t *buffer)
     ptr += didLoadFromBuffer(ptr);
 
     // Verify that the number of written bytes matches the snapshot size
-    assert(ptr - buffer == size());
+    assert((size_t)(ptr - buffer) == size());
     // panic("Loaded %d bytes (expected %d)\n", ptr - buffer, size());
 
     return ptr - buffer;
@@ -256,8 +256,12 @@ HardwareComponent::save(uint8_t *buffer)
     ptr += didSaveToBuffer(ptr);
 
     // Verify that the number of written bytes matches the snapshot size
-    assert(ptr - buffer == size());
-    debug(SNAP_DEBUG, "Checksum: %x\n", fnv_1a_64(buffer, ptr - buffer));
+    assert((size_t)(ptr - buffer) == size());
+
+    // Only hash the buffer if the checksum is printed
+    if (SNAP_DEBUG <= debugLevel) {
+        debug(SNAP_DEBUG, "Checksum: %x\n", fnv_1a_64(buffer, ptr - buffer));
+    }
     // hexdump(buffer, MIN(ptr - buffer, 128));
 
     return ptr - buffer;
@@ -0,0 +1,199 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "RewindBuffer.h"
+
+// Size of a segment header (offset and length)
+static const size_t segmentHeader = 2 * sizeof(uint32_t);
+
+RewindBuffer::RewindBuffer()
+{
+    setDescription("RewindBuffer");
+}
+
+RewindBuffer::~RewindBuffer()
+{
+    delete[] ring;
+    delete[] current;
+    delete[] scratch;
+    delete[] encoded;
+}
+
+void
+RewindBuffer::setCapacity(size_t bytes)
+{
+    clear();
+
+    delete[] ring;
+    ring = bytes ? new uint8_t[bytes] : NULL;
+    capacity = bytes;
+}
+
+void
+RewindBuffer::clear()
+{
+    deltas.clear();
+    head = 0;
+    stateSize = 0;
+}
+
+uint8_t *
+RewindBuffer::prepare(size_t size)
+{
+    // Start from scratch if the state size has changed
+    if (size != allocated) {
+
+        clear();
+
+        delete[] current;
+        delete[] scratch;
+        delete[] encoded;
+
+        current = new uint8_t[size];
+        scratch = new uint8_t[size];
+        encoded = new uint8_t[size + segmentHeader * (size / 16 + 2)];
+        allocated = size;
+    }
+
+    return scratch;
+}
+
+void
+RewindBuffer::commit(Frame frame)
+{
+    assert(scratch != NULL);
+
+    if (stateSize) {
+
+        // Store a delta leading back to the current state
+        size_t size = encode(current, scratch, encoded);
+
+        if (reserve(size)) {
+            memcpy(ring + head, encoded, size);
+            deltas.push_back(Delta { head, size, currentFrame });
+            head += size;
+        } else {
+            deltas.clear();
+            head = 0;
+        }
+    }
+
+    // Make the new state the current state
+    swap(current, scratch);
+    currentFrame = frame;
+    stateSize = allocated;
+}
+
+const uint8_t *
+RewindBuffer::rewind(Frame frame)
+{
+    if (!stateSize || oldestFrame() > frame) return NULL;
+
+    // Roll back the current state until the target frame has been reached
+    while (currentFrame > frame) {
+
+        Delta &delta = deltas.back();
+        apply(ring + delta.offset, delta.size, current);
+        currentFrame = delta.frame;
+        head = delta.offset;
+        deltas.pop_back();
+    }
+
+    return current;
+}
+
+size_t
+RewindBuffer::encode(const uint8_t *oldState, const uint8_t *newState, uint8_t *dst)
+{
+    uint8_t *ptr = dst;
+    size_t words = stateSize / 8;
+
+    auto emit = [&](size_t from, size_t to) {
+
+        uint32_t offset = (uint32_t)from, length = (uint32_t)(to - from);
+        memcpy(ptr, &offset, sizeof(offset));
+        memcpy(ptr + sizeof(offset), &length, sizeof(length));
+        ptr += segmentHeader;
+
+        for (size_t i = from; i < to; i++) *ptr++ = oldState[i] ^ newState[i];
+    };
+
+    auto differs = [&](size_t w) {
+        uint64_t a, b;
+        memcpy(&a, oldState + 8 * w, 8);
+        memcpy(&b, newState + 8 * w, 8);
+        return a != b;
+    };
+
+    for (size_t w = 0; w < words; w++) {
+
+        if (!differs(w)) continue;
+
+        // Extend the segment until two consecutive words are equal
+        size_t last = w;
+        for (size_t v = w + 1; v < words && v - last <= 2; v++) {
+            if (differs(v)) last = v;
+        }
+
+        emit(8 * w, 8 * (last + 1));
+        w = last;
+    }
+
+    // Check the remaining bytes
+    if (memcmp(oldState + 8 * words, newState + 8 * words, stateSize % 8)) {
+        emit(8 * words, stateSize);
+    }
+
+    return ptr - dst;
+}
+
+void
+RewindBuffer::apply(const uint8_t *delta, size_t size, uint8_t *state)
+{
+    const uint8_t *end = delta + size;
+
+    while (delta < end) {
+
+        uint32_t offset, length;
+        memcpy(&offset, delta, sizeof(offset));
+        memcpy(&length, delta + sizeof(offset), sizeof(length));
+        delta += segmentHeader;
+
+        assert(offset + length <= stateSize);
+        for (uint32_t i = 0; i < length; i++) state[offset + i] ^= delta[i];
+        delta += length;
+    }
+}
+
+bool
+RewindBuffer::reserve(size_t size)
+{
+    if (size > capacity) return false;
+
+    if (head + size > capacity) {
+
+        // Drop all deltas behind the write position and wrap around
+        while (!deltas.empty() && deltas.front().offset >= head) {
+            deltas.pop_front();
+        }
+        head = 0;
+    }
+
+    /* Drop all deltas that overlap with the reserved area. All deltas behind
+     * the write position are older than the ones in front of it. Hence, the
+     * oldest delta is always the first one to be overwritten.
+     */
+    while (!deltas.empty() &&
+           deltas.front().offset >= head &&
+           deltas.front().offset < head + size) {
+        deltas.pop_front();
+    }
+
+    return true;
+}
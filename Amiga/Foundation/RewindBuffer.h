@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _REWIND_BUFFER_INC
+#define _REWIND_BUFFER_INC
+
+#include "AmigaObject.h"
+
+#include <deque>
+
+/* A history of emulator states for stepping back in time.
+ *
+ * The buffer keeps the most recent state in full and all older states as
+ * backward deltas. A delta is the XOR of two consecutive states, stored as a
+ * list of (offset, length, data) segments covering all differing bytes.
+ * Applying the newest delta to the current state yields the previous state,
+ * applying the next one yields the state before, and so on.
+ * The deltas are stored in a preallocated ring buffer. If a new delta does
+ * not fit, the oldest deltas are dropped.
+ */
+class RewindBuffer : public AmigaObject {
+
+    struct Delta {
+
+        // Location of the delta in the ring buffer
+        size_t offset;
+        size_t size;
+
+        // Frame number of the state that is restored by this delta
+        Frame frame;
+    };
+
+    // Ring buffer storing all deltas
+    uint8_t *ring = NULL;
+    size_t capacity = 0;
+
+    // Write position in the ring buffer
+    size_t head = 0;
+
+    // All stored deltas, from oldest to newest
+    std::deque<Delta> deltas;
+
+    // The most recent state
+    uint8_t *current = NULL;
+    Frame currentFrame = 0;
+
+    // Scratch buffers for serializing and encoding a new state
+    uint8_t *scratch = NULL;
+    uint8_t *encoded = NULL;
+
+    // Size of the allocated state buffers
+    size_t allocated = 0;
+
+    // Size of the current state (0 if no state has been recorded yet)
+    size_t stateSize = 0;
+
+public:
+
+    RewindBuffer();
+    ~RewindBuffer();
+
+    // Sets the memory budget of the ring buffer and deletes the history
+    void setCapacity(size_t bytes);
+    size_t getCapacity() { return capacity; }
+
+    // Deletes all recorded states
+    void clear();
+
+    // Returns the number of recorded states
+    size_t count() { return stateSize ? deltas.size() + 1 : 0; }
+
+    // Returns the frame number of the oldest recorded state
+    Frame oldestFrame() { return deltas.empty() ? currentFrame : deltas.front().frame; }
+
+    /* Returns a buffer for serializing the next state.
+     * The state is recorded by a subsequent call to commit().
+     */
+    uint8_t *prepare(size_t size);
+
+    // Records the state that has been written into the prepared buffer
+    void commit(Frame frame);
+
+    /* Rolls back the history to the most recent state that is not newer than
+     * the specified frame. All newer states are deleted. Returns the restored
+     * state or NULL if no such state exists. In the latter case, the history
+     * is left untouched.
+     */
+    const uint8_t *rewind(Frame frame);
+
+private:
+
+    // Computes the XOR delta between two states
+    size_t encode(const uint8_t *oldState, const uint8_t *newState, uint8_t *dst);
+
+    // Applies a delta to a state
+    void apply(const uint8_t *delta, size_t size, uint8_t *state);
+
+    // Reserves space for a new delta in the ring buffer
+    bool reserve(size_t size);
+};
+
+#endif
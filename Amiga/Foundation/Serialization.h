@@ -15,6 +15,9 @@
 #include "ChangeRecorder.h"
 #include "va_types.h"
 
+#include <type_traits>
+#include <algorithm>
+
 
 //
 // Basic memory buffer I/O
@@ -72,12 +75,50 @@ inline void write64(uint8_t *& buffer, uint64_t value)
     write32(buffer, (uint32_t)(value));
 }
 
+/* Bulk array I/O
+ * Arrays of scalar types are transferred with a single memcpy. Opposed to
+ * single items, which are stored in big endian byte order, the elements of
+ * those arrays are stored in little endian byte order. This matches the byte
+ * order of all supported host architectures. Only big endian hosts have to
+ * swap bytes which makes snapshots portable between both kinds of machines.
+ */
+
+template <class T> constexpr bool isBulkType()
+{
+    return std::is_arithmetic<T>::value || std::is_enum<T>::value;
+}
+
+template <class T> inline void swapElements(uint8_t *, size_t )
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if (sizeof(T) > 1) {
+        for (size_t i = 0; i < count; i++, buffer += sizeof(T)) {
+            std::reverse(buffer, buffer + sizeof(T));
+        }
+    }
+#endif
+}
+
+template <class T> inline void readBulk(uint8_t *& buffer, T *values, size_t count)
+{
+    memcpy((void *)values, buffer, count * sizeof(T));
+    swapElements<T>((uint8_t *)values, count);
+    buffer += count * sizeof(T);
+}
+
+template <class T> inline void writeBulk(uint8_t *& buffer, const T *values, size_t count)
+{
+    memcpy(buffer, (const void *)values, count * sizeof(T));
+    swapElements<T>(buffer, count);
+    buffer += count * sizeof(T);
+}
+
 //
 // Counter (determines the state size)
 //
 
 #define COUNT(type) \
-auto& operator&(type& v) \
+auto& operator&(type& ) \
 { \
 count += sizeof(type); \
 return *this; \
@@ -135,8 +176,12 @@ public:
     template <class T, size_t N>
     SerCounter& operator&(T (&v)[N])
     {
-        for(size_t i = 0; i < N; ++i) {
-            *this & v[i];
+        if constexpr (isBulkType<T>()) {
+            count += sizeof(v);
+        } else {
+            for(size_t i = 0; i < N; ++i) {
+                *this & v[i];
+            }
         }
         return *this;
     }
@@ -205,8 +250,12 @@ public:
     template <class T, size_t N>
     SerReader& operator&(T (&v)[N])
     {
-        for(size_t i = 0; i < N; ++i) {
-            *this & v[i];
+        if constexpr (isBulkType<T>()) {
+            readBulk(ptr, v, N);
+        } else {
+            for(size_t i = 0; i < N; ++i) {
+                *this & v[i];
+            }
         }
         return *this;
     }
@@ -281,8 +330,12 @@ public:
     template <class T, size_t N>
     SerWriter& operator&(T (&v)[N])
     {
-        for(size_t i = 0; i < N; ++i) {
-            *this & v[i];
+        if constexpr (isBulkType<T>()) {
+            writeBulk(ptr, v, N);
+        } else {
+            for(size_t i = 0; i < N; ++i) {
+                *this & v[i];
+            }
         }
         return *this;
     }
@@ -348,8 +401,12 @@ public:
     template <class T, size_t N>
     SerResetter& operator&(T (&v)[N])
     {
-        for(size_t i = 0; i < N; ++i) {
-            *this & v[i];
+        if constexpr (isBulkType<T>()) {
+            memset((void *)v, 0, sizeof(v));
+        } else {
+            for(size_t i = 0; i < N; ++i) {
+                *this & v[i];
+            }
         }
         return *this;
     }
@@ -0,0 +1,171 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "lz_utils.h"
+
+#include <string.h>
+
+// Minimum match length
+static const size_t minMatch = 4;
+
+// Blocks must not contain back references in the last bytes of the input
+static const size_t lastLiterals = 5;
+static const size_t matchLimit = 12;
+
+// Size of the hash table used for finding matches (in bits)
+static const int hashBits = 14;
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+static inline uint32_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - hashBits);
+}
+
+static inline uint8_t *writeLength(uint8_t *dst, size_t length)
+{
+    for (; length >= 255; length -= 255) *dst++ = 255;
+    *dst++ = (uint8_t)length;
+    return dst;
+}
+
+static inline uint8_t *writeBlock(uint8_t *dst,
+                                  const uint8_t *literals, size_t numLiterals,
+                                  size_t distance, size_t matchLength)
+{
+    uint8_t *token = dst++;
+
+    // Write the literals
+    *token = (uint8_t)((numLiterals < 15 ? numLiterals : 15) << 4);
+    if (numLiterals >= 15) dst = writeLength(dst, numLiterals - 15);
+    memcpy(dst, literals, numLiterals);
+    dst += numLiterals;
+
+    // The last block ends here
+    if (matchLength == 0) return dst;
+
+    // Write the back reference
+    *dst++ = (uint8_t)(distance & 0xFF);
+    *dst++ = (uint8_t)(distance >> 8);
+    matchLength -= minMatch;
+    *token |= (uint8_t)(matchLength < 15 ? matchLength : 15);
+    if (matchLength >= 15) dst = writeLength(dst, matchLength - 15);
+
+    return dst;
+}
+
+size_t lzBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t lzCompress(const uint8_t *src, size_t size, uint8_t *dst)
+{
+    uint32_t table[1 << hashBits];
+    memset(table, 0, sizeof(table));
+
+    uint8_t *out = dst;
+    size_t anchor = 0;
+    size_t i = 1;
+
+    while (size > matchLimit && i < size - matchLimit) {
+
+        uint32_t sequence = read32(src + i);
+        uint32_t h = hash(sequence);
+        size_t candidate = table[h];
+        table[h] = (uint32_t)i;
+
+        if (i - candidate > 0xFFFF || read32(src + candidate) != sequence) {
+
+            // Skip faster through data that does not compress
+            i += 1 + ((i - anchor) >> 6);
+            continue;
+        }
+
+        // Extend the match
+        size_t length = minMatch;
+        size_t limit = size - lastLiterals;
+        while (i + length < limit && src[candidate + length] == src[i + length]) {
+            length++;
+        }
+
+        out = writeBlock(out, src + anchor, i - anchor, i - candidate, length);
+        i += length;
+        anchor = i;
+    }
+
+    // Write the remaining bytes as literals
+    out = writeBlock(out, src + anchor, size - anchor, 0, 0);
+
+    return out - dst;
+}
+
+static inline bool readLength(const uint8_t *&src, const uint8_t *end, size_t &length)
+{
+    uint8_t byte;
+
+    do {
+        if (src == end) return false;
+        byte = *src++;
+        length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+bool lzDecompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dstSize)
+{
+    const uint8_t *end = src + size;
+    uint8_t *out = dst;
+    uint8_t *outEnd = dst + dstSize;
+
+    while (src < end) {
+
+        uint8_t token = *src++;
+
+        // Copy literals
+        size_t numLiterals = token >> 4;
+        if (numLiterals == 15 && !readLength(src, end, numLiterals)) return false;
+        if (numLiterals > (size_t)(end - src)) return false;
+        if (numLiterals > (size_t)(outEnd - out)) return false;
+        memcpy(out, src, numLiterals);
+        src += numLiterals;
+        out += numLiterals;
+
+        // The last block has no back reference
+        if (src == end) break;
+
+        // Resolve back reference
+        if (end - src < 2) return false;
+        size_t distance = src[0] | (src[1] << 8);
+        src += 2;
+        if (distance == 0 || distance > (size_t)(out - dst)) return false;
+
+        size_t length = token & 0xF;
+        if (length == 15 && !readLength(src, end, length)) return false;
+        length += minMatch;
+        if (length > (size_t)(outEnd - out)) return false;
+
+        const uint8_t *match = out - distance;
+        if (distance >= length) {
+            memcpy(out, match, length);
+            out += length;
+        } else {
+            // Overlapping copy
+            while (length--) *out++ = *match++;
+        }
+    }
+
+    return out == outEnd;
+}
@@ -0,0 +1,50 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _LZ_UTILS_INC
+#define _LZ_UTILS_INC
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* A fast LZ77 codec
+ *
+ * The compressed data is a sequence of blocks, each consisting of a token
+ * byte, a run of literal bytes, and a back reference:
+ *
+ *     Token:      Upper nibble: Number of literals (15 = more bytes follow)
+ *                 Lower nibble: Match length - 4 (15 = more bytes follow)
+ *     Literals:   Bytes copied to the output unchanged
+ *     Reference:  16-bit distance (little endian) of the matching string
+ *
+ * Lengths >= 15 are continued by bytes which are added up until a byte
+ * different to 255 is read. The last block has no back reference. This is
+ * the block format used by LZ4.
+ */
+
+// Returns the maximum size of the compressed representation
+size_t lzBound(size_t size);
+
+/* Compresses a buffer
+ *
+ *     Input:   size bytes of uncompressed data
+ *     Output:  A buffer of at least lzBound(size) bytes.
+ *     Returns: The number of written bytes
+ */
+size_t lzCompress(const uint8_t *src, size_t size, uint8_t *dst);
+
+/* Decompresses a buffer
+ *
+ *     Input:   size bytes of compressed data
+ *     Output:  A buffer for exactly dstSize bytes of uncompressed data
+ *     Returns: false if the compressed data is corrupted
+ */
+bool lzDecompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dstSize);
+
+#endif
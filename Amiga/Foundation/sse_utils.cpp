@@ -9,9 +9,11 @@
 
 #include "sse_utils.h"
 
+#ifdef __SSSE3__
+
 #include <x86intrin.h>
 
-void transposeSSE(uint16_t *source, uint8_t* target)
+static inline __m128i transpose(uint16_t *source)
 {
     // We receive the matrix rows in little endian format
     // 0.lo 0.hi 1.lo 1.hi 2.lo 2.hi 3.lo 3.hi  ........  7.lo 7.hi
@@ -19,8 +21,8 @@ void transposeSSE(uint16_t *source, uint8_t* target)
     // Rearrange the byte order to
     // 0.hi 1.hi 2.hi 3.hi ...  7.hi 0.lo 1.lo 2.lo 3.lo  ...  7.lo
     
-    const uint8_t mask1[16] = { 1,3,5,7,9,11,13,15,0,2,4,6,8,10,12,14 };
-    __m128i shuffled = _mm_shuffle_epi8(*(__m128i *)source, *(__m128i *)mask1);
+    const __m128i mask1 = _mm_setr_epi8(1,3,5,7,9,11,13,15,0,2,4,6,8,10,12,14);
+    __m128i shuffled = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)source), mask1);
     
     // Cut off column values in the order
     // col0 col8 col1 col9 col2 col10 col3 col11 ... col7 col15
@@ -34,9 +36,355 @@ void transposeSSE(uint16_t *source, uint8_t* target)
     // Shuffle back to
     // col0 col1 col2 col3 col4 col5 col6 col7 ...  col14 col15
     
-    const uint8_t mask2[16] = { 0,2,4,6,8,10,12,14,1,3,5,7,9,11,13,15 };
-    shuffled = _mm_shuffle_epi8(result.sse, *(__m128i *)mask2);
-    
+    const __m128i mask2 = _mm_setr_epi8(0,2,4,6,8,10,12,14,1,3,5,7,9,11,13,15);
+    return _mm_shuffle_epi8(result.sse, mask2);
+}
+
+void transposeSSE(uint16_t *source, uint8_t* target)
+{
     // Read the result back from the SSE registers
-    _mm_store_si128((__m128i *)target, shuffled);
+    _mm_storeu_si128((__m128i *)target, transpose(source));
+}
+
+void transposeDoubleSSE(uint16_t *source, uint8_t* target)
+{
+    __m128i columns = transpose(source);
+
+    // Duplicate each column value and read the result back
+    _mm_storeu_si128((__m128i *)target, _mm_unpacklo_epi8(columns, columns));
+    _mm_storeu_si128((__m128i *)(target + 16), _mm_unpackhi_epi8(columns, columns));
+}
+
+void colorizeSSE(const uint8_t *src, uint32_t *dst, const uint32_t *table, int count)
+{
+    int i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+
+        // Check if all 16 indices are equal
+        __m128i index = _mm_loadu_si128((__m128i *)(src + i));
+        __m128i first = _mm_set1_epi8(src[i]);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(index, first)) == 0xFFFF) {
+
+            __m128i color = _mm_set1_epi32(table[src[i]]);
+            _mm_storeu_si128((__m128i *)(dst + i), color);
+            _mm_storeu_si128((__m128i *)(dst + i + 4), color);
+            _mm_storeu_si128((__m128i *)(dst + i + 8), color);
+            _mm_storeu_si128((__m128i *)(dst + i + 12), color);
+            continue;
+        }
+
+#ifdef __AVX2__
+
+        for (int j = 0; j < 16; j += 8) {
+            __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *)(src + i + j)));
+            __m256i color = _mm256_i32gather_epi32((const int *)table, index, 4);
+            _mm256_storeu_si256((__m256i *)(dst + i + j), color);
+        }
+
+#else
+
+        for (int j = 0; j < 16; j++) dst[i + j] = table[src[i + j]];
+
+#endif
+    }
+
+    // Translate the remaining pixels
+    for (; i < count; i++) dst[i] = table[src[i]];
+}
+
+void encodeOddEvenSSE(uint8_t *target, const uint8_t *source, size_t count)
+{
+    const __m128i mask = _mm_set1_epi8(0x55);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i data = _mm_loadu_si128((__m128i *)(source + i));
+        __m128i odd = _mm_and_si128(_mm_srli_epi16(data, 1), mask);
+        __m128i even = _mm_and_si128(data, mask);
+        _mm_storeu_si128((__m128i *)(target + i), odd);
+        _mm_storeu_si128((__m128i *)(target + i + count), even);
+    }
+    for (; i < count; i++) {
+        target[i] = (source[i] >> 1) & 0x55;
+        target[i + count] = source[i] & 0x55;
+    }
+}
+
+void decodeOddEvenSSE(uint8_t *target, const uint8_t *source, size_t count)
+{
+    const __m128i mask = _mm_set1_epi8(0x55);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i odd = _mm_and_si128(_mm_loadu_si128((__m128i *)(source + i)), mask);
+        __m128i even = _mm_and_si128(_mm_loadu_si128((__m128i *)(source + i + count)), mask);
+        _mm_storeu_si128((__m128i *)(target + i), _mm_or_si128(_mm_add_epi8(odd, odd), even));
+    }
+    for (; i < count; i++) {
+        target[i] = ((source[i] & 0x55) << 1) | (source[i + count] & 0x55);
+    }
+}
+
+void addClockBitsSSE(uint8_t *buffer, size_t count)
+{
+    const __m128i data = _mm_set1_epi8(0x55);
+    const __m128i clock = _mm_set1_epi8((char)0xAA);
+    const __m128i right = _mm_set1_epi8(0x2A);
+    const __m128i carry = _mm_set1_epi8((char)0x80);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+
+        // Only the data bits are taken into account, including buffer[-1]
+        __m128i value = _mm_and_si128(_mm_loadu_si128((__m128i *)(buffer + i)), data);
+        __m128i prev = _mm_loadu_si128((__m128i *)(buffer + i - 1));
+
+        // A clock bit is set if both neighbouring data bits are zero
+        __m128i lShifted = _mm_add_epi8(value, value);
+        __m128i rShifted = _mm_and_si128(_mm_srli_epi16(value, 1), right);
+        __m128i pShifted = _mm_and_si128(_mm_slli_epi16(prev, 7), carry);
+        __m128i cBitsInv = _mm_or_si128(_mm_or_si128(lShifted, rShifted), pShifted);
+        __m128i cBits = _mm_xor_si128(cBitsInv, clock);
+
+        _mm_storeu_si128((__m128i *)(buffer + i), _mm_or_si128(value, cBits));
+    }
+    for (; i < count; i++) {
+        uint8_t value = buffer[i] & 0x55;
+        uint8_t cBitsInv = (value << 1) | (value >> 1) | (buffer[i - 1] << 7);
+        buffer[i] = value | (cBitsInv ^ 0xAA);
+    }
 }
+
+const uint8_t *findSyncMarkSSE(const uint8_t *begin, const uint8_t *end)
+{
+    const __m128i sync1 = _mm_set1_epi8(0x44);
+    const __m128i sync2 = _mm_set1_epi8((char)0x89);
+    const uint8_t *p = begin;
+
+    for (; p + 16 <= end; p += 16) {
+
+        // Compare all four bytes of the sync mark at 16 positions at once
+        __m128i match = _mm_and_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)p), sync1),
+                          _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(p + 1)), sync2)),
+            _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(p + 2)), sync1),
+                          _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(p + 3)), sync2)));
+
+        if (int mask = _mm_movemask_epi8(match)) return p + __builtin_ctz(mask);
+    }
+    for (; p < end; p++) {
+        if (p[0] == 0x44 && p[1] == 0x89 && p[2] == 0x44 && p[3] == 0x89) return p;
+    }
+    return NULL;
+}
+
+void loadWordsSSE(uint16_t *target, const uint8_t *source, size_t count, bool reverse)
+{
+    const __m128i swap = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+    const __m128i flip = _mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+    size_t i = 0;
+
+    if (reverse) {
+        for (; i + 8 <= count; i += 8) {
+            __m128i words = _mm_loadu_si128((__m128i *)(source + 2 * (count - 8 - i)));
+            _mm_storeu_si128((__m128i *)(target + i), _mm_shuffle_epi8(words, flip));
+        }
+        for (; i < count; i++) {
+            const uint8_t *p = source + 2 * (count - 1 - i);
+            target[i] = (p[0] << 8) | p[1];
+        }
+    } else {
+        for (; i + 8 <= count; i += 8) {
+            __m128i words = _mm_loadu_si128((__m128i *)(source + 2 * i));
+            _mm_storeu_si128((__m128i *)(target + i), _mm_shuffle_epi8(words, swap));
+        }
+        for (; i < count; i++) {
+            target[i] = (source[2 * i] << 8) | source[2 * i + 1];
+        }
+    }
+}
+
+void storeWordsSSE(uint8_t *target, const uint16_t *source, size_t count, bool reverse)
+{
+    const __m128i swap = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+    const __m128i flip = _mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+    size_t i = 0;
+
+    if (reverse) {
+        for (; i + 8 <= count; i += 8) {
+            __m128i words = _mm_loadu_si128((__m128i *)(source + i));
+            _mm_storeu_si128((__m128i *)(target + 2 * (count - 8 - i)), _mm_shuffle_epi8(words, flip));
+        }
+        for (; i < count; i++) {
+            uint8_t *p = target + 2 * (count - 1 - i);
+            p[0] = source[i] >> 8;
+            p[1] = source[i] & 0xFF;
+        }
+    } else {
+        for (; i + 8 <= count; i += 8) {
+            __m128i words = _mm_loadu_si128((__m128i *)(source + i));
+            _mm_storeu_si128((__m128i *)(target + 2 * i), _mm_shuffle_epi8(words, swap));
+        }
+        for (; i < count; i++) {
+            target[2 * i] = source[i] >> 8;
+            target[2 * i + 1] = source[i] & 0xFF;
+        }
+    }
+}
+
+template <class Minterm> static inline uint16_t
+blitWords(Minterm minterm, uint16_t *d, const uint16_t *a, const uint16_t *b, const uint16_t *c,
+          size_t count, int ash, int bsh, bool desc)
+{
+    // Each output word is ((hi << (16 - shift)) | (lo >> shift)) & 0xFFFF
+    const __m128i aShiftL = _mm_cvtsi32_si128(16 - ash);
+    const __m128i aShiftR = _mm_cvtsi32_si128(ash);
+    const __m128i bShiftL = _mm_cvtsi32_si128(16 - bsh);
+    const __m128i bShiftR = _mm_cvtsi32_si128(bsh);
+    const __m128i lanes = _mm_setr_epi16(0,1,2,3,4,5,6,7);
+    __m128i any = _mm_setzero_si128();
+
+    for (size_t i = 0; i < count; i += 8) {
+
+        // Run the barrel shifters. The previous word is the high word in
+        // ascending mode and the low word in descending mode.
+        __m128i aCur = _mm_loadu_si128((__m128i *)(a + i));
+        __m128i aPrev = _mm_loadu_si128((__m128i *)(a + i - 1));
+        __m128i bCur = _mm_loadu_si128((__m128i *)(b + i));
+        __m128i bPrev = _mm_loadu_si128((__m128i *)(b + i - 1));
+        __m128i aHi = desc ? aCur : aPrev, aLo = desc ? aPrev : aCur;
+        __m128i bHi = desc ? bCur : bPrev, bLo = desc ? bPrev : bCur;
+        __m128i ahold = _mm_or_si128(_mm_sll_epi16(aHi, aShiftL), _mm_srl_epi16(aLo, aShiftR));
+        __m128i bhold = _mm_or_si128(_mm_sll_epi16(bHi, bShiftL), _mm_srl_epi16(bLo, bShiftR));
+        __m128i chold = _mm_loadu_si128((__m128i *)(c + i));
+
+        // Run the minterm logic circuit
+        __m128i dhold = minterm(ahold, bhold, chold);
+        _mm_storeu_si128((__m128i *)(d + i), dhold);
+
+        // Ignore the lanes behind the end of the block
+        if (count - i < 8) {
+            dhold = _mm_and_si128(dhold, _mm_cmplt_epi16(lanes, _mm_set1_epi16((short)(count - i))));
+        }
+        any = _mm_or_si128(any, dhold);
+    }
+
+    any = _mm_or_si128(any, _mm_srli_si128(any, 8));
+    any = _mm_or_si128(any, _mm_srli_si128(any, 4));
+    any = _mm_or_si128(any, _mm_srli_si128(any, 2));
+    return (uint16_t)_mm_cvtsi128_si32(any);
+}
+
+uint16_t blitWordsSSE(uint16_t *d, const uint16_t *a, const uint16_t *b, const uint16_t *c,
+                      size_t count, int ash, int bsh, bool desc, uint8_t minterm)
+{
+    switch (minterm) {
+
+        case 0x00: // Clear
+
+            return blitWords([](__m128i , __m128i , __m128i ) {
+                return _mm_setzero_si128(); }, d, a, b, c, count, ash, bsh, desc);
+
+        case 0xF0: // D = A
+
+            return blitWords([](__m128i a, __m128i , __m128i ) {
+                return a; }, d, a, b, c, count, ash, bsh, desc);
+
+        case 0xCA: // Cookie-cut: D = AB + /AC
+
+            return blitWords([](__m128i a, __m128i b, __m128i c) {
+                return _mm_or_si128(_mm_and_si128(a, b), _mm_andnot_si128(a, c));
+            }, d, a, b, c, count, ash, bsh, desc);
+
+        case 0x5A: // D = A xor C
+
+            return blitWords([](__m128i a, __m128i , __m128i c) {
+                return _mm_xor_si128(a, c); }, d, a, b, c, count, ash, bsh, desc);
+
+        default:
+        {
+            // Expand each minterm bit into a mask
+            __m128i m[8];
+            for (int i = 0; i < 8; i++) {
+                m[i] = _mm_set1_epi16((minterm & (1 << i)) ? -1 : 0);
+            }
+
+            return blitWords([&m](__m128i a, __m128i b, __m128i c) {
+
+                __m128i bc = _mm_and_si128(b, c);
+                __m128i bC = _mm_andnot_si128(c, b);
+                __m128i Bc = _mm_andnot_si128(b, c);
+                __m128i BC = _mm_andnot_si128(_mm_or_si128(b, c), _mm_set1_epi16(-1));
+
+                // Combine the terms with A set and with A cleared
+                __m128i hi = _mm_or_si128(_mm_or_si128(_mm_and_si128(bc, m[7]),
+                                                       _mm_and_si128(bC, m[6])),
+                                          _mm_or_si128(_mm_and_si128(Bc, m[5]),
+                                                       _mm_and_si128(BC, m[4])));
+                __m128i lo = _mm_or_si128(_mm_or_si128(_mm_and_si128(bc, m[3]),
+                                                       _mm_and_si128(bC, m[2])),
+                                          _mm_or_si128(_mm_and_si128(Bc, m[1]),
+                                                       _mm_and_si128(BC, m[0])));
+                return _mm_or_si128(_mm_and_si128(a, hi), _mm_andnot_si128(a, lo));
+            }, d, a, b, c, count, ash, bsh, desc);
+        }
+    }
+}
+
+uint16_t fillWordsSSE(uint16_t *data, size_t count, bool exclusive, bool &carry)
+{
+    const __m128i lanes = _mm_setr_epi16(0,1,2,3,4,5,6,7);
+    __m128i carryIn = _mm_set1_epi16(carry ? -1 : 0);
+    __m128i any = _mm_setzero_si128();
+
+    for (size_t i = 0; i < count; i += 8) {
+
+        // Compute the prefix XOR inside each word
+        __m128i value = _mm_loadu_si128((__m128i *)(data + i));
+        __m128i prefix = _mm_xor_si128(value, _mm_slli_epi16(value, 1));
+        prefix = _mm_xor_si128(prefix, _mm_slli_epi16(prefix, 2));
+        prefix = _mm_xor_si128(prefix, _mm_slli_epi16(prefix, 4));
+        prefix = _mm_xor_si128(prefix, _mm_slli_epi16(prefix, 8));
+
+        // Chain the carries across words with a prefix XOR across lanes
+        __m128i parity = _mm_srai_epi16(prefix, 15);
+        __m128i chain = _mm_slli_si128(parity, 2);
+        chain = _mm_xor_si128(chain, _mm_slli_si128(chain, 2));
+        chain = _mm_xor_si128(chain, _mm_slli_si128(chain, 4));
+        chain = _mm_xor_si128(chain, _mm_slli_si128(chain, 8));
+        chain = _mm_xor_si128(chain, carryIn);
+
+        // Fill the words
+        __m128i fill = _mm_xor_si128(_mm_slli_epi16(prefix, 1), chain);
+        __m128i result = exclusive ? _mm_xor_si128(value, fill) : _mm_or_si128(value, fill);
+        _mm_storeu_si128((__m128i *)(data + i), result);
+
+        // Determine the carry coming out of each word
+        __m128i carryOut = _mm_xor_si128(chain, parity);
+
+        if (count - i < 8) {
+
+            // Ignore the lanes behind the end of the block
+            int valid = (int)(count - i);
+            result = _mm_and_si128(result, _mm_cmplt_epi16(lanes, _mm_set1_epi16((short)valid)));
+            any = _mm_or_si128(any, result);
+            carry = (_mm_movemask_epi8(carryOut) >> (2 * (valid - 1))) & 1;
+            break;
+        }
+
+        // Broadcast the carry of the last word into all lanes
+        any = _mm_or_si128(any, result);
+        carryOut = _mm_shufflehi_epi16(carryOut, 0xFF);
+        carryIn = _mm_unpackhi_epi64(carryOut, carryOut);
+        carry = _mm_cvtsi128_si32(carryIn) & 1;
+    }
+
+    any = _mm_or_si128(any, _mm_srli_si128(any, 8));
+    any = _mm_or_si128(any, _mm_srli_si128(any, 4));
+    any = _mm_or_si128(any, _mm_srli_si128(any, 2));
+    return (uint16_t)_mm_cvtsi128_si32(any);
+}
+
+#endif
@@ -11,6 +11,10 @@
 #define _SEE_UTILS_INC
 
 #include <stdint.h>
+#include <stddef.h>
+
+// The functions in this file require the SSSE3 instruction set
+#ifdef __SSSE3__
 
 /* Transposes a 8 x 16 bit matrix using SSE3 extensions
  *
@@ -34,4 +38,95 @@
  */
 void transposeSSE(uint16_t p[8], uint8_t* result);
 
+/* Same as transposeSSE(), but writes each column value twice
+ *
+ *     Output:  A pointer to an uint8_t[32] array.
+ *              Array elements at index 2i and 2i+1 will contain the value on
+ *              the i-th column. This is the pixel layout of a lores line.
+ */
+void transposeDoubleSSE(uint16_t p[8], uint8_t* result);
+
+/* Translates a sequence of color register indices into RGBA values
+ *
+ *     Input:   A pointer to an uint8_t[count] array with register indices
+ *              and a lookup table mapping each index to an RGBA value.
+ *     Output:  A pointer to an uint32_t[count] array.
+ *
+ *     Blocks of 16 identical indices (e.g., the background) are written
+ *     with vector stores. All other blocks are looked up with a gather
+ *     instruction if AVX2 is available and element by element otherwise.
+ */
+void colorizeSSE(const uint8_t *src, uint32_t *dst, const uint32_t *table, int count);
+
+/* Splits a sequence of bytes into odd and even bits (MFM encoding)
+ *
+ *     Output:  The odd bits of all source bytes are written to the first
+ *              count bytes of the target buffer, the even bits to the second
+ *              count bytes. No clock bits are added.
+ */
+void encodeOddEvenSSE(uint8_t *target, const uint8_t *source, size_t count);
+
+/* Merges odd and even bits into a sequence of bytes (MFM decoding)
+ *
+ *     Input:   A pointer to the odd bits (count bytes), followed by the
+ *              even bits (count bytes).
+ */
+void decodeOddEvenSSE(uint8_t *target, const uint8_t *source, size_t count);
+
+/* Adds the MFM clock bits to a sequence of data bits
+ *
+ *     The clock bit of a byte depends on its predecessor. Hence, buffer[-1]
+ *     must be accessible. Because the predecessor's clock bits are not
+ *     taken into account, 16 bytes are processed at once.
+ */
+void addClockBitsSSE(uint8_t *buffer, size_t count);
+
+/* Searches for the MFM sync mark 0x44 0x89 0x44 0x89
+ *
+ *     Returns the position of the first sync mark starting in the range
+ *     [begin, end) or NULL if there is none. The three bytes following the
+ *     range must be accessible.
+ */
+const uint8_t *findSyncMarkSSE(const uint8_t *begin, const uint8_t *end);
+
+/* Converts a block of big endian Chip Ram words into native words
+ *
+ *     If reverse is false, target[i] is the i-th word of the block. If it is
+ *     true, the words are stored in reverse order, i.e., target[0] is the
+ *     last word of the block. The latter is the processing order of the
+ *     Blitter in descending mode.
+ */
+void loadWordsSSE(uint16_t *target, const uint8_t *source, size_t count, bool reverse);
+
+// Inverse of loadWordsSSE()
+void storeWordsSSE(uint8_t *target, const uint16_t *source, size_t count, bool reverse);
+
+/* Runs a block of words through the data path of the Blitter
+ *
+ *     Input:   The A, B, and C words in processing order. A must already be
+ *              masked with the first and last word masks. a[-1] and b[-1]
+ *              must contain the words preceding the block. ash and bsh are
+ *              the shift values used by the Fast Blitter (0 ... 16), desc
+ *              indicates descending mode.
+ *     Output:  The D words in processing order.
+ *
+ *     Returns the bitwise OR of all D words. All arrays are accessed in
+ *     chunks of 8 words. Hence, up to 7 words behind each array must be
+ *     accessible. Copy (D = A), cookie-cut, clear, and XOR minterms run in
+ *     dedicated loops. All other minterms are evaluated generically.
+ */
+uint16_t blitWordsSSE(uint16_t *d, const uint16_t *a, const uint16_t *b, const uint16_t *c,
+                      size_t count, int ash, int bsh, bool desc, uint8_t minterm);
+
+/* Runs a block of words through the fill logic of the Blitter
+ *
+ *     The words are filled in processing order, starting with the least
+ *     significant bit of data[0]. carry is the fill carry going into the
+ *     block and receives the carry coming out of it. Returns the bitwise OR
+ *     of all filled words. Up to 7 words behind the array must be accessible.
+ */
+uint16_t fillWordsSSE(uint16_t *data, size_t count, bool exclusive, bool &carry);
+
+#endif
+
 #endif
@@ -17,7 +17,7 @@
 // Snapshot version number
 #define V_MAJOR 0
 #define V_MINOR 1
-#define V_SUBMINOR 0
+#define V_SUBMINOR 1
 
 // Assertion checking (uncomment in a release build)
 // #define NDEBUG
@@ -86,5 +86,6 @@ static const int BLT_CHECKSUM  = 2;  // Blitter checksums
 // #define ALIGN_DRIVE_HEAD // Makes drive operations deterministic
 // #define SLOW_BLT_DEBUG   // Execute all slow Blitter instructions in one chunk
 // #define AGNUS_EXEC_DEBUG // Falls back to a simpler Agnus execution function
+// #define EVENT_PROFILE    // Records service counts and times of all events
 
 #endif
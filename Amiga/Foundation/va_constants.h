@@ -267,7 +267,7 @@ static const double masterCyclesPerFrame = (masterClockFrequency * 1000000.0) /
 
 
 // Printable names for all custom registers
-static const char *customReg[256] = {
+static const char *const customReg[256] = {
     
     "BLTDDAT",        "DMACONR",        "VPOSR",
     "VHPOSR",         "DSKDATR",        "JOY0DAT",
@@ -44,7 +44,7 @@ hexdump(uint8_t *addr, size_t size)
     while (size) {
 
         size_t num = MIN(size, 16);
-        for (int i = 0; i < num; i++) {
+        for (size_t i = 0; i < num; i++) {
             printf("%02X ", *(addr++));
         }
         size -= num;
@@ -205,6 +205,49 @@ matchingBufferHeader(const uint8_t *buffer, const uint8_t *header, size_t length
     return true;
 }
 
+#ifdef __APPLE__
+
+uint64_t
+timeInNanos()
+{
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+
+    return mach_absolute_time() * tb.numer / tb.denom;
+}
+
+void
+waitUntil(uint64_t targetTime)
+{
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+
+    mach_wait_until(targetTime * tb.denom / tb.numer);
+}
+
+#else
+
+uint64_t
+timeInNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void
+waitUntil(uint64_t targetTime)
+{
+    struct timespec ts;
+    ts.tv_sec = targetTime / 1000000000;
+    ts.tv_nsec = targetTime % 1000000000;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+#endif
+
 void
 sleepMicrosec(unsigned usec)
 {
@@ -214,24 +257,24 @@ sleepMicrosec(unsigned usec)
 }
 
 int64_t
-sleepUntil(uint64_t kernelTargetTime, uint64_t kernelEarlyWakeup)
+sleepUntil(uint64_t targetTime, uint64_t earlyWakeup)
 {
-    uint64_t now = mach_absolute_time();
+    uint64_t now = timeInNanos();
     int64_t jitter;
     
-    if (now > kernelTargetTime) {
+    if (now > targetTime) {
         printf("Too slow\n");
         return 0;
     }
     
     // Sleep
-    // printf("Sleeping for %lld\n", kernelTargetTime - kernelEarlyWakeup);
-    mach_wait_until(kernelTargetTime - kernelEarlyWakeup);
+    // printf("Sleeping for %lld\n", targetTime - earlyWakeup);
+    waitUntil(targetTime - earlyWakeup);
     
     // Count some sheep to increase precision
     unsigned sheep = 0;
     do {
-        jitter = mach_absolute_time() - kernelTargetTime;
+        jitter = timeInNanos() - targetTime;
         sheep++;
     } while (jitter < 0);
     // printf("Counted %d sheep (%lld)\n", sheep, jitter);
@@ -280,7 +323,7 @@ uint32_t crc32(const uint8_t *addr, size_t size)
     for(int i = 0; i < 256; i++) table[i] = crc32forByte(i);
 
     // Compute CRC-32 checksum
-     for(int i = 0; i < size; i++)
+     for(size_t i = 0; i < size; i++)
        result = table[(uint8_t)result ^ addr[i]] ^ result >> 8;
 
     return result;
@@ -20,9 +20,12 @@
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <arpa/inet.h>
 #include <time.h>
+#ifdef __APPLE__
 #include <mach/mach.h>
 #include <mach/mach_time.h>
+#endif
 #include <unistd.h>
 #include <pthread.h>
 #include <errno.h>
@@ -104,16 +107,16 @@
 #define WRITE_BIT(x,nr,value) ((value) ? SET_BIT(x, nr) : CLR_BIT(x, nr))
 
 // Copies a single bit from x to y.
-#define COPY_BIT(x,y,nr) ((y) = ((y) & ~(1 << (nr)) | ((x) & (1 << (nr)))))
+#define COPY_BIT(x,y,nr) ((y) = (((y) & ~(1 << (nr))) | ((x) & (1 << (nr)))))
 
 // Replaces the low byte in a 16-bit value
-#define REPLACE_LO(x,y) (((x) & ~0x00FF) | y)
+#define REPLACE_LO(x,y) (((x) & ~0x00FF) | (y))
 
 // Replaces the low byte in a 16-bit value
 #define REPLACE_HI(x,y) (((x) & ~0xFF00) | ((y) << 8))
 
 // Replaces the low word in a 32-bit value
-#define REPLACE_LO_WORD(x,y) (((x) & ~0xFFFF) | y)
+#define REPLACE_LO_WORD(x,y) (((x) & ~0xFFFF) | (y))
 
 // Replaces the high word in a 23-bit value
 #define REPLACE_HI_WORD(x,y) (((x) & ~0xFFFF0000) | ((y) << 16))
@@ -233,17 +236,26 @@ bool matchingBufferHeader(const uint8_t *buffer, const uint8_t *header, size_t l
 // Managing time
 //
 
+/* Returns the current value of a monotonic system clock in nanoseconds.
+ * On macOS, the value is derived from the Mach kernel timer. On all other
+ * platforms, the POSIX monotonic clock is used.
+ */
+uint64_t timeInNanos();
+
+// Puts the current thread to sleep until timeInNanos() reaches targetTime.
+void waitUntil(uint64_t targetTime);
+
 // Puts the current thread to sleep for a given amout of micro seconds.
 void sleepMicrosec(unsigned usec);
 
-/* Sleeps until the kernel timer reaches kernelTargetTime
- * - kernelEarlyWakeup To increase timing precision, the function
- *                     wakes up the thread earlier by this amount and waits
- *                     actively in a delay loop until the deadline is reached.
- * Returns the overshoot time (jitter), measured in kernel time units. Smaller
+/* Sleeps until the monotonic clock reaches targetTime
+ * - earlyWakeup To increase timing precision, the function wakes up the
+ *               thread earlier by this amount and waits actively in a delay
+ *               loop until the deadline is reached.
+ * Returns the overshoot time (jitter), measured in nanoseconds. Smaller
  * values are better, 0 is best.
  */
-int64_t sleepUntil(uint64_t kernelTargetTime, uint64_t kernelEarlyWakeup);
+int64_t sleepUntil(uint64_t targetTime, uint64_t earlyWakeup);
 
 
 //
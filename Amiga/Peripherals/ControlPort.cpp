@@ -91,6 +91,10 @@ ControlPort::joydat()
 
         case CPD_JOYSTICK:
             return nr == 1 ? joystick1.joydat() : joystick2.joydat();
+
+        default:
+            assert(false);
+            return 0;
     }
 }
 
@@ -114,6 +118,10 @@ ControlPort::ciapa()
         case CPD_JOYSTICK:
 
             return nr == 1 ? joystick1.ciapa() : joystick2.ciapa();
+
+        default:
+            assert(false);
+            return 0xFF;
     }
 }
 
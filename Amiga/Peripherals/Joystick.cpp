@@ -34,7 +34,7 @@ Joystick::_dump()
 }
 
 size_t
-Joystick::didLoadFromBuffer(uint8_t *buffer)
+Joystick::didLoadFromBuffer(uint8_t *)
 {
     // Discard any active joystick movements
     button = false;
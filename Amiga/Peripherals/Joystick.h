@@ -56,12 +56,12 @@ public:
     //
 
     template <class T>
-    void applyToPersistentItems(T& worker)
+    void applyToPersistentItems(T& )
     {
     }
 
     template <class T>
-    void applyToResetItems(T& worker)
+    void applyToResetItems(T& )
     {
     }
 
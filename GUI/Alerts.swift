@@ -26,6 +26,12 @@ extension NSError {
             [NSLocalizedDescriptionKey: "The document \"\(filename)\" could not be opened.",
                 NSLocalizedRecoverySuggestionErrorKey: "The file appears to be corrupt. It's contents does not match the purported format."])
     }
+
+    static func snapshotWriteError(filename: String) -> NSError {
+        return NSError(domain: "vAmiga", code: 0, userInfo:
+            [NSLocalizedDescriptionKey: "The document \"\(filename)\" could not be saved.",
+                NSLocalizedRecoverySuggestionErrorKey: "The snapshot could not be written to disk."])
+    }
 }
 
 public extension MetalView {
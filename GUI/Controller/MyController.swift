@@ -294,15 +294,10 @@ class MyController: NSWindowController, MessageReceiver {
     // Updates the warp status
     func updateWarp() {
 
-        var warp: Bool
+        // In auto mode, the disk controller switches warp mode on and off
+        amiga.configure(VA_AUTO_WARP, enable: warpMode == .auto && warpLoad)
 
-        switch warpMode {
-        case .auto: warp = amiga.diskController.spinning() && warpLoad
-        case .on: warp = true
-        case .off: warp = false
-        }
-
-        warp ? amiga.warpOn() : amiga.warpOff()
+        warpMode == .on ? amiga.warpOn() : amiga.warpOff()
     }
     
     // Returns the icon of the sand clock in the bottom bar
@@ -691,7 +686,6 @@ extension MyController {
         case MSG_DRIVE_MOTOR_ON,
              MSG_DRIVE_MOTOR_OFF:
             
-            updateWarp()
             refreshStatusBar()
 
         case MSG_DRIVE_HEAD:
@@ -720,6 +714,13 @@ extension MyController {
         case MSG_AUTOSNAPSHOT_SAVED:
             break
 
+        case MSG_SNAPSHOT_WRITTEN:
+            mydocument?.finishSave(success: true)
+
+        case MSG_SNAPSHOT_WRITE_ERROR:
+            track("Failed to write snapshot")
+            mydocument?.finishSave(success: false)
+
         case MSG_ROM_MISSING:
             myDocument?.showConfigurationAltert(msg.type.rawValue)
             openPreferences(tab: "Roms")
@@ -214,7 +214,7 @@ extension SnapshotDialog {
         }
         
         // Get snapshot data
-        var data: Data
+        var data: Data?
         if tableView == autoTableView {
             data = amiga.autoSnapshotData(index)
         } else {
@@ -222,9 +222,15 @@ extension SnapshotDialog {
             data = amiga.userSnapshotData(index)
         }
         
+        // The snapshot may have been deleted in the meantime
+        guard let contents = data else {
+            track("Snapshot \(index) is no longer available")
+            return false
+        }
+        
         let pboardType = NSPasteboard.PasteboardType.fileContents
         pboard.declareTypes([pboardType], owner: self)
-        let fileWrapper = FileWrapper.init(regularFileWithContents: data)
+        let fileWrapper = FileWrapper.init(regularFileWithContents: contents)
         fileWrapper.preferredFilename = "Snapshot.vam"
         pboard.write(fileWrapper)
 
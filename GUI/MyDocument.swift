@@ -217,22 +217,61 @@ class MyDocument: NSDocument {
     // Saving
     //
     
-    override open func data(ofType typeName: String) throws -> Data {
+    /*
+     Snapshots are compressed and written to disk by the emulator's background
+     thread. The save operation completes when the emulator reports
+     MSG_SNAPSHOT_WRITTEN or MSG_SNAPSHOT_WRITE_ERROR.
+     */
+    var pendingSave: (url: URL, handler: (Error?) -> Void)?
+    
+    override open func save(to url: URL,
+                            ofType typeName: String,
+                            for saveOperation: NSDocument.SaveOperationType,
+                            completionHandler: @escaping (Error?) -> Void) {
         
         track("Trying to write \(typeName) file.")
         
-        if typeName == "vAmiga" {
+        if typeName != "vAmiga" {
+            super.save(to: url, ofType: typeName, for: saveOperation,
+                       completionHandler: completionHandler)
+            return
+        }
+        
+        pendingSave = (url, { error in
             
-            // Take snapshot
-            if let snapshot = SnapshotProxy.make(withAmiga: amiga) {
-
-                // Write to data buffer
-                if let data = NSMutableData.init(length: snapshot.sizeOnDisk()) {
-                    snapshot.write(toBuffer: data.mutableBytes)
-                    return data as Data
+            if error == nil {
+                
+                // Update the document state as NSDocument does it
+                switch saveOperation {
+                    
+                case .saveOperation, .saveAsOperation, .autosaveInPlaceOperation:
+                    self.fileURL = url
+                    self.fileType = typeName
+                    self.fileModificationDate = Date()
+                    self.updateChangeCount(.changeCleared)
+                    
+                case .autosaveElsewhereOperation:
+                    self.autosavedContentsFileURL = url
+                    self.updateChangeCount(.changeAutosaved)
+                    
+                default:
+                    break
                 }
             }
-        }
+            completionHandler(error)
+        })
+        amiga.saveSnapshot(url.path)
+    }
+    
+    func finishSave(success: Bool) {
+        
+        guard let (url, handler) = pendingSave else { return }
+        
+        pendingSave = nil
+        handler(success ? nil : NSError.snapshotWriteError(filename: url.lastPathComponent))
+    }
+    
+    override open func data(ofType typeName: String) throws -> Data {
         
         throw NSError(domain: NSOSStatusErrorDomain, code: unimpErr, userInfo: nil)
     }
@@ -168,14 +168,15 @@ struct AmigaFileWrapper;
 
 - (NSData *) autoSnapshotData:(NSInteger)nr;
 - (NSData *) userSnapshotData:(NSInteger)nr;
-- (unsigned char *) autoSnapshotImageData:(NSInteger)nr;
-- (unsigned char *) userSnapshotImageData:(NSInteger)nr;
+- (NSData *) autoSnapshotImageData:(NSInteger)nr;
+- (NSData *) userSnapshotImageData:(NSInteger)nr;
 - (NSSize) autoSnapshotImageSize:(NSInteger)nr;
 - (NSSize) userSnapshotImageSize:(NSInteger)nr;
 - (time_t) autoSnapshotTimestamp:(NSInteger)nr;
 - (time_t) userSnapshotTimestamp:(NSInteger)nr;
 
 - (void) takeUserSnapshot;
+- (void) saveSnapshot:(NSString *)path;
 
 - (void) deleteAutoSnapshot:(NSInteger)nr;
 - (void) deleteUserSnapshot:(NSInteger)nr;
@@ -1486,45 +1486,53 @@ struct ADFFileWrapper { ADFFile *adf; };
     return wrapper->amiga->numUserSnapshots();
 }
 - (NSData *)autoSnapshotData:(NSInteger)nr {
-    Snapshot *snapshot = wrapper->amiga->autoSnapshot((unsigned)nr);
-    return [NSData dataWithBytes: (void *)snapshot->getHeader()
-                          length: snapshot->sizeOnDisk()];
+    shared_ptr<Snapshot> snapshot = wrapper->amiga->autoSnapshot((unsigned)nr);
+    vector<uint8_t> buffer;
+    if (!snapshot || !snapshot->writeCompressed(buffer)) return nil;
+    return [NSData dataWithBytes:buffer.data() length:buffer.size()];
 }
 - (NSData *)userSnapshotData:(NSInteger)nr {
-    Snapshot *snapshot = wrapper->amiga->userSnapshot((unsigned)nr);
-    return [NSData dataWithBytes: (void *)snapshot->getHeader()
-                          length: snapshot->sizeOnDisk()];
+    shared_ptr<Snapshot> snapshot = wrapper->amiga->userSnapshot((unsigned)nr);
+    vector<uint8_t> buffer;
+    if (!snapshot || !snapshot->writeCompressed(buffer)) return nil;
+    return [NSData dataWithBytes:buffer.data() length:buffer.size()];
 }
-- (unsigned char *)autoSnapshotImageData:(NSInteger)nr
+- (NSData *)autoSnapshotImageData:(NSInteger)nr
 {
-    Snapshot *s = wrapper->amiga->autoSnapshot((int)nr);
-    return s ? s->getImageData() : NULL;
+    shared_ptr<Snapshot> s = wrapper->amiga->autoSnapshot((int)nr);
+    return s ? [NSData dataWithBytes:s->getImageData()
+                              length:4 * s->getImageWidth() * s->getImageHeight()] : nil;
 }
-- (unsigned char *)userSnapshotImageData:(NSInteger)nr
+- (NSData *)userSnapshotImageData:(NSInteger)nr
 {
-    Snapshot *s = wrapper->amiga->userSnapshot((int)nr);
-    return s ? s->getImageData() : NULL;
+    shared_ptr<Snapshot> s = wrapper->amiga->userSnapshot((int)nr);
+    return s ? [NSData dataWithBytes:s->getImageData()
+                              length:4 * s->getImageWidth() * s->getImageHeight()] : nil;
 }
 - (NSSize) autoSnapshotImageSize:(NSInteger)nr {
-    Snapshot *s = wrapper->amiga->autoSnapshot((int)nr);
+    shared_ptr<Snapshot> s = wrapper->amiga->autoSnapshot((int)nr);
     return s ? NSMakeSize(s->getImageWidth(), s->getImageHeight()) : NSMakeSize(0,0);
 }
 - (NSSize) userSnapshotImageSize:(NSInteger)nr {
-    Snapshot *s = wrapper->amiga->userSnapshot((int)nr);
+    shared_ptr<Snapshot> s = wrapper->amiga->userSnapshot((int)nr);
     return s ? NSMakeSize(s->getImageWidth(), s->getImageHeight()) : NSMakeSize(0,0);
 }
 - (time_t)autoSnapshotTimestamp:(NSInteger)nr {
-    Snapshot *s = wrapper->amiga->autoSnapshot((int)nr);
+    shared_ptr<Snapshot> s = wrapper->amiga->autoSnapshot((int)nr);
     return s ? s->getTimestamp() : 0;
 }
 - (time_t)userSnapshotTimestamp:(NSInteger)nr {
-    Snapshot *s = wrapper->amiga->userSnapshot((int)nr);
+    shared_ptr<Snapshot> s = wrapper->amiga->userSnapshot((int)nr);
     return s ? s->getTimestamp() : 0;
 }
 - (void)takeUserSnapshot
 {
     wrapper->amiga->takeUserSnapshotSafe();
 }
+- (void)saveSnapshot:(NSString *)path
+{
+    wrapper->amiga->saveSnapshotToFile([path UTF8String]);
+}
 - (void)deleteAutoSnapshot:(NSInteger)nr
 {
     wrapper->amiga->deleteAutoSnapshot((unsigned)nr);
@@ -32,12 +32,11 @@ public extension AmigaProxy {
         return df(item.tag)
     }
     
-    func image(data: UnsafeMutablePointer<UInt8>?, size: NSSize) -> NSImage {
+    func image(data: Data?, size: NSSize) -> NSImage {
         
-        var bitmap = data
         let width = Int(size.width)
         let height = Int(size.height)
-        let imageRep = NSBitmapImageRep(bitmapDataPlanes: &bitmap,
+        let imageRep = NSBitmapImageRep(bitmapDataPlanes: nil,
                                         pixelsWide: width,
                                         pixelsHigh: height,
                                         bitsPerSample: 8,
@@ -47,6 +46,12 @@ public extension AmigaProxy {
                                         colorSpaceName: NSColorSpaceName.calibratedRGB,
                                         bytesPerRow: 4*width,
                                         bitsPerPixel: 32)
+        
+        // Copy the pixel data into the buffer owned by the image
+        if let data = data, let bitmap = imageRep?.bitmapData {
+            data.copyBytes(to: bitmap, count: min(data.count, 4 * width * height))
+        }
+        
         let image = NSImage(size: (imageRep?.size)!)
         image.addRepresentation(imageRep!)
         image.makeGlossy()
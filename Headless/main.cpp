@@ -0,0 +1,161 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+/* Headless batch runner
+ * This program runs the emulator core without a graphical user interface. It
+ * powers up a single Amiga, emulates a fixed number of frames, and prints
+ * some statistical information together with a checksum of the final frame.
+ * It is intended for regression and capture jobs on build servers.
+ */
+
+#include "Amiga.h"
+#include <getopt.h>
+
+static void
+usage(const char *prg)
+{
+    fprintf(stderr, "Usage: %s -k <kickstart> [options]\n\n", prg);
+    fprintf(stderr, "  -k <file>    Kickstart Rom or Boot Rom\n");
+    fprintf(stderr, "  -e <file>    Extended Rom\n");
+    fprintf(stderr, "  -a <file>    ADF file to insert into df0\n");
+    fprintf(stderr, "  -c <KB>      Chip Ram size (default: 512)\n");
+    fprintf(stderr, "  -s <KB>      Slow Ram size (default: 512)\n");
+    fprintf(stderr, "  -F <KB>      Fast Ram size (default: 0)\n");
+    fprintf(stderr, "  -f <frames>  Number of frames to emulate (default: 500)\n");
+    fprintf(stderr, "  -w           Run in warp mode\n");
+    fprintf(stderr, "  -u           Run unthrottled\n");
+    fprintf(stderr, "  -i           Sync Agnus after every CPU instruction\n");
+    fprintf(stderr, "  -p <file>    Write the event profile as CSV (needs EVENT_PROFILE)\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *kickPath = NULL;
+    const char *extPath = NULL;
+    const char *adfPath = NULL;
+    long chipRam = 512;
+    long slowRam = 512;
+    long fastRam = 0;
+    long frames = 500;
+    bool warp = false;
+    bool unthrottled = false;
+    bool batch = true;
+    const char *profilePath = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "k:e:a:c:s:F:f:wuip:h")) != -1) {
+
+        switch (c) {
+
+            case 'k': kickPath = optarg; break;
+            case 'e': extPath = optarg; break;
+            case 'a': adfPath = optarg; break;
+            case 'c': chipRam = atol(optarg); break;
+            case 's': slowRam = atol(optarg); break;
+            case 'F': fastRam = atol(optarg); break;
+            case 'f': frames = atol(optarg); break;
+            case 'w': warp = true; break;
+            case 'u': unthrottled = true; break;
+            case 'i': batch = false; break;
+            case 'p': profilePath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (kickPath == NULL || frames <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Amiga *amiga = new Amiga();
+
+    // Configure memory
+    if (!amiga->configure(VA_CHIP_RAM, chipRam) ||
+        !amiga->configure(VA_SLOW_RAM, slowRam) ||
+        !amiga->configure(VA_FAST_RAM, fastRam)) {
+        fprintf(stderr, "Invalid memory configuration\n");
+        return 1;
+    }
+    amiga->configure(VA_CPU_BATCH, batch);
+
+    // Install Roms
+    if (!amiga->mem.loadRomFromFile(kickPath)) {
+        fprintf(stderr, "Cannot load Rom %s\n", kickPath);
+        return 1;
+    }
+    if (extPath && !amiga->mem.loadExtFromFile(extPath)) {
+        fprintf(stderr, "Cannot load Extended Rom %s\n", extPath);
+        return 1;
+    }
+
+    // Insert disk
+    if (adfPath) {
+
+        ADFFile *adf = ADFFile::makeWithFile(adfPath);
+        if (!adf) {
+            fprintf(stderr, "Cannot load ADF %s\n", adfPath);
+            return 1;
+        }
+        amiga->paula.diskController.insertDisk(adf, 0);
+        delete adf;
+    }
+
+    // Power up
+    amiga->powerOn();
+    if (!amiga->isPoweredOn()) {
+        fprintf(stderr, "Failed to power up the emulator\n");
+        return 1;
+    }
+    amiga->disableDebugging();
+    if (warp) amiga->warpOn();
+    amiga->setUnthrottled(unthrottled);
+
+    // Run the emulator until the requested frame has been reached
+    amiga->stopFrame = amiga->agnus.frame + frames;
+    Cycle startClock = amiga->agnus.clock;
+    amiga->agnus.clearStats();
+    amiga->agnus.clearEventProfile();
+    uint64_t start = timeInNanos();
+    amiga->run();
+    while (amiga->isRunning()) sleepMicrosec(1000);
+    uint64_t elapsed = timeInNanos() - start;
+
+    // Print results
+    ScreenBuffer buffer = amiga->denise.pixelEngine.getStableLongFrame();
+    uint64_t checksum = fnv_1a_64((uint8_t *)buffer.data, PIXELS * sizeof(int32_t));
+    double seconds = elapsed / 1000000000.0;
+    AgnusStats stats = amiga->agnus.getStats();
+    long dmaCycles = stats.steppedCycles + stats.skippedCycles;
+
+    printf("Frames:   %lld\n", amiga->agnus.frame);
+    printf("Seconds:  %.3f\n", seconds);
+    printf("Fps:      %.1f\n", seconds > 0 ? frames / seconds : 0.0);
+    printf("Cycles/s: %.0f\n",
+           seconds > 0 ? (amiga->agnus.clock - startClock) / seconds : 0.0);
+    printf("Skipped:  %.1f %% of %ld DMA cycles\n",
+           dmaCycles ? 100.0 * stats.skippedCycles / dmaCycles : 0.0, dmaCycles);
+    printf("PC:       %06X\n", amiga->cpu.getPC());
+    printf("Checksum: %016llx\n", (unsigned long long)checksum);
+
+    // Write the event profile
+    if (profilePath) {
+
+        FILE *file = fopen(profilePath, "w");
+        if (!file) {
+            fprintf(stderr, "Cannot write %s\n", profilePath);
+            return 1;
+        }
+        amiga->agnus.dumpEventProfile(file);
+        fclose(file);
+    }
+
+    delete amiga;
+    return 0;
+}
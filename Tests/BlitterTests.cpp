@@ -0,0 +1,519 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+
+//
+// Reference implementation (one word at a time, as in the Hardware Reference)
+//
+
+static uint16_t
+minterm(uint16_t a, uint16_t b, uint16_t c, uint8_t mt)
+{
+    uint16_t result = 0;
+
+    for (int i = 0; i < 8; i++) {
+        if (!(mt & (1 << i))) continue;
+        result |= ((i & 4) ? a : ~a) & ((i & 2) ? b : ~b) & ((i & 1) ? c : ~c);
+    }
+    return result;
+}
+
+static uint16_t
+fill(uint16_t data, bool &carry, bool exclusive)
+{
+    uint16_t result = 0;
+
+    for (int i = 0; i < 16; i++) {
+
+        bool bit = data & (1 << i);
+        bool out = exclusive ? (bit != carry) : (bit || carry);
+        if (out) result |= 1 << i;
+        if (bit) carry = !carry;
+    }
+    return result;
+}
+
+static void
+referenceCopyBlit(Blitter &bl, Memory &mem)
+{
+    bool useA = bl.bltconUSEA();
+    bool useB = bl.bltconUSEB();
+    bool useC = bl.bltconUSEC();
+    bool useD = bl.bltconUSED();
+    bool desc = bl.bltconDESC();
+
+    int incr = desc ? -2 : 2;
+    int ash = desc ? 16 - bl.bltconASH() : bl.bltconASH();
+    int bsh = desc ? 16 - bl.bltconBSH() : bl.bltconBSH();
+
+    uint32_t apt = bl.bltapt, bpt = bl.bltbpt, cpt = bl.bltcpt, dpt = bl.bltdpt;
+    bl.aold = 0;
+    bl.bold = 0;
+
+    for (int y = 0; y < bl.bltsizeH; y++) {
+
+        bool carry = bl.bltconFCI();
+        uint16_t mask = bl.bltafwm;
+
+        for (int x = 0; x < bl.bltsizeW; x++) {
+
+            if (x == bl.bltsizeW - 1) mask &= bl.bltalwm;
+
+            if (useA) { bl.anew = mem.peek16<BUS_BLITTER>(apt); INC_CHIP_PTR_BY(apt, incr); }
+            if (useB) { bl.bnew = mem.peek16<BUS_BLITTER>(bpt); INC_CHIP_PTR_BY(bpt, incr); }
+            if (useC) { bl.chold = mem.peek16<BUS_BLITTER>(cpt); INC_CHIP_PTR_BY(cpt, incr); }
+
+            if (desc) {
+                bl.ahold = HI_W_LO_W(bl.anew & mask, bl.aold) >> ash;
+                bl.bhold = HI_W_LO_W(bl.bnew, bl.bold) >> bsh;
+            } else {
+                bl.ahold = HI_W_LO_W(bl.aold, bl.anew & mask) >> ash;
+                bl.bhold = HI_W_LO_W(bl.bold, bl.bnew) >> bsh;
+            }
+            bl.aold = bl.anew & mask;
+            bl.bold = bl.bnew;
+
+            bl.dhold = minterm(bl.ahold, bl.bhold, bl.chold, bl.bltcon0 & 0xFF);
+            if (bl.bltconFE()) bl.dhold = fill(bl.dhold, carry, bl.bltconEFE());
+            if (bl.dhold) bl.bzero = false;
+
+            if (useD) { mem.poke16<BUS_BLITTER>(dpt, bl.dhold); INC_CHIP_PTR_BY(dpt, incr); }
+
+            mask = 0xFFFF;
+        }
+
+        if (useA) INC_CHIP_PTR_BY(apt, desc ? -bl.bltamod : bl.bltamod);
+        if (useB) INC_CHIP_PTR_BY(bpt, desc ? -bl.bltbmod : bl.bltbmod);
+        if (useC) INC_CHIP_PTR_BY(cpt, desc ? -bl.bltcmod : bl.bltcmod);
+        if (useD) INC_CHIP_PTR_BY(dpt, desc ? -bl.bltdmod : bl.bltdmod);
+    }
+
+    bl.bltapt = apt;
+    bl.bltbpt = bpt;
+    bl.bltcpt = cpt;
+    bl.bltdpt = dpt;
+}
+
+static void
+referenceLineBlit(Blitter &bl, Memory &mem)
+{
+    bool useA = bl.bltconUSEA();
+    bool useC = bl.bltconUSEC();
+    bool oneDot = bl.bltcon1 & 0x02;
+    bool signedDecision = bl.bltcon1 & 0x40;
+
+    // Decode the octant
+    bool sud = bl.bltcon1 & 0x10, sul = bl.bltcon1 & 0x08, aul = bl.bltcon1 & 0x04;
+    bool xMajor = sud;
+    bool xInc = xMajor ? !aul : !sul;
+    bool yInc = xMajor ? !sul : !aul;
+
+    uint16_t pattern = (bl.bnew >> bl.bltconBSH()) | (bl.bnew << (16 - bl.bltconBSH()));
+    uint32_t decision = bl.bltapt;
+    int shift = bl.bltconASH();
+    uint32_t cpt = CHIP_PTR(bl.bltcpt);
+    uint32_t dpt = CHIP_PTR(bl.bltdpt);
+    uint16_t c = bl.chold, d = 0, b = 0;
+    bool dotDrawn = false;
+
+    auto moveX = [&]() {
+        shift += xInc ? 1 : -1;
+        if (shift == 16) { shift = 0; INC_CHIP_PTR_BY(cpt, 2); }
+        if (shift == -1) { shift = 15; INC_CHIP_PTR_BY(cpt, -2); }
+    };
+    auto moveY = [&]() {
+        INC_CHIP_PTR_BY(cpt, yInc ? bl.bltcmod : -bl.bltcmod);
+    };
+
+    for (int i = 0; i < bl.bltsizeH; i++) {
+
+        if (useC) c = mem.peek16<BUS_BLITTER>(cpt);
+
+        uint16_t a = (bl.anew & bl.bltafwm) >> shift;
+        if (xMajor && oneDot) {
+            if (dotDrawn) a = 0;
+            dotDrawn = true;
+        }
+        b = (pattern & 1) ? 0xFFFF : 0;
+
+        d = minterm(a, b, c, bl.bltcon0 & 0xFF);
+        if (useC) mem.poke16<BUS_BLITTER>(dpt, d);
+        if (d) bl.bzero = false;
+
+        pattern = (pattern << 1) | (pattern >> 15);
+
+        // Step along the minor axis if the decision variable is not negative
+        if (signedDecision) {
+            decision += useA ? bl.bltbmod : 0;
+        } else {
+            decision += useA ? bl.bltamod : 0;
+            if (xMajor) { moveY(); dotDrawn = false; } else { moveX(); }
+        }
+        signedDecision = (int16_t)decision < 0;
+
+        // Step along the major axis
+        if (xMajor) moveX(); else moveY();
+        dpt = cpt;
+    }
+
+    bl.setBltconASH(shift);
+    bl.bnew = b;
+    bl.bltapt = CHIP_PTR(decision);
+    bl.bltcpt = cpt;
+    bl.bltdpt = dpt;
+}
+
+//
+// Test setup
+//
+
+// Runs the same test on two machines. One uses the emulator, one the reference.
+struct BlitterTest {
+
+    Amiga *amiga[2];
+    uint32_t chipSize;
+
+    BlitterTest() {
+
+        for (int i = 0; i < 2; i++) {
+            amiga[i] = new Amiga();
+            amiga[i]->configure(VA_CHIP_RAM, 512);
+        }
+        chipSize = amiga[0]->mem.getConfig().chipSize;
+
+        TestRandom rnd;
+        rnd.fill(amiga[0]->mem.chip, chipSize);
+        memcpy(amiga[1]->mem.chip, amiga[0]->mem.chip, chipSize);
+    }
+
+    ~BlitterTest() { delete amiga[0]; delete amiga[1]; }
+
+    Blitter &blitter(int i) { return amiga[i]->agnus.blitter; }
+    Memory &mem(int i) { return amiga[i]->mem; }
+
+    // Copies all Blitter registers from the first to the second machine
+    void sync() {
+        Blitter &b0 = blitter(0), &b1 = blitter(1);
+        b1.bltcon0 = b0.bltcon0; b1.bltcon1 = b0.bltcon1;
+        b1.bltafwm = b0.bltafwm; b1.bltalwm = b0.bltalwm;
+        b1.bltsizeW = b0.bltsizeW; b1.bltsizeH = b0.bltsizeH;
+        b1.bltapt = b0.bltapt; b1.bltbpt = b0.bltbpt;
+        b1.bltcpt = b0.bltcpt; b1.bltdpt = b0.bltdpt;
+        b1.bltamod = b0.bltamod; b1.bltbmod = b0.bltbmod;
+        b1.bltcmod = b0.bltcmod; b1.bltdmod = b0.bltdmod;
+        b1.anew = b0.anew; b1.bnew = b0.bnew;
+        b1.aold = b0.aold; b1.bold = b0.bold;
+        b1.ahold = b0.ahold; b1.bhold = b0.bhold;
+        b1.chold = b0.chold; b1.dhold = b0.dhold;
+        b1.bzero = b0.bzero;
+        mem(1).dataBus = mem(0).dataBus;
+    }
+
+    // Compares the Blitter state of both machines
+    bool sameRegisters() {
+        Blitter &b0 = blitter(0), &b1 = blitter(1);
+        return
+        b0.bltapt == b1.bltapt && b0.bltbpt == b1.bltbpt &&
+        b0.bltcpt == b1.bltcpt && b0.bltdpt == b1.bltdpt &&
+        b0.anew == b1.anew && b0.bnew == b1.bnew &&
+        b0.aold == b1.aold && b0.bold == b1.bold &&
+        b0.ahold == b1.ahold && b0.bhold == b1.bhold &&
+        b0.chold == b1.chold && b0.dhold == b1.dhold &&
+        b0.bzero == b1.bzero && mem(0).dataBus == mem(1).dataBus;
+    }
+
+    // Compares the Chip Ram of both machines
+    bool sameMemory() {
+        return memcmp(mem(0).chip, mem(1).chip, chipSize) == 0;
+    }
+};
+
+//
+// Copy blits
+//
+
+static void
+setupCopyBlit(BlitterTest &test, TestRandom &rnd)
+{
+    static const uint8_t common[] = { 0x00, 0xF0, 0xCA, 0x5A, 0xFF, 0xCC, 0xAA, 0x0A };
+    Blitter &bl = test.blitter(0);
+    uint32_t chipSize = test.chipSize;
+
+    // Favor the minterms with a dedicated code path
+    bl.bltcon0 = rnd.next();
+    if (rnd.next(2)) bl.bltcon0 = (bl.bltcon0 & 0xFF00) | common[rnd.next(8)];
+    bl.bltcon1 = rnd.next() & 0xF01E;
+    if (rnd.next(4) == 0) bl.bltcon1 &= ~0x18;
+
+    bl.bltafwm = rnd.next();
+    bl.bltalwm = rnd.next();
+    if (rnd.next(2)) { bl.bltafwm = 0xFFFF; bl.bltalwm = 0xFFFF; }
+
+    bl.bltsizeW = 1 + rnd.next(rnd.next(4) ? 40 : 300);
+    bl.bltsizeH = 1 + rnd.next(rnd.next(3) ? 20 : 200);
+
+    /* Place the channels anywhere, close to the end of Chip Ram (to make them
+     * wrap around), or close to each other (to make them overlap).
+     */
+    uint32_t base = rnd.next(chipSize);
+    auto pointer = [&]() {
+        switch (rnd.next(5)) {
+            case 0:  return (uint32_t)rnd.next(chipSize) & ~1;
+            case 1:  return (uint32_t)(chipSize - 2 * rnd.next(64)) & (chipSize - 1) & ~1;
+            default: return (uint32_t)(base + 2 * rnd.next(80) - 80) & (chipSize - 1) & ~1;
+        }
+    };
+    bl.bltapt = pointer();
+    bl.bltbpt = pointer();
+    bl.bltcpt = pointer();
+    bl.bltdpt = rnd.next(3) ? pointer() : bl.bltcpt;
+
+    auto modulo = [&]() {
+        return (int16_t)((rnd.next(3) ? (int)rnd.next(200) - 100 : (int16_t)rnd.next()) & ~1);
+    };
+    bl.bltamod = modulo();
+    bl.bltbmod = modulo();
+    bl.bltcmod = modulo();
+    bl.bltdmod = modulo();
+
+    bl.anew = rnd.next();
+    bl.bnew = rnd.next();
+    bl.chold = rnd.next();
+    bl.bzero = true;
+}
+
+static void
+runCopyBlit(Blitter &bl)
+{
+    int nr = ((bl.bltcon0 >> 7) & 0b11110) | !!bl.bltconDESC();
+    (bl.*bl.blitfunc[nr])();
+}
+
+static long
+checkCopyBlits()
+{
+    long failures = 0;
+    BlitterTest test;
+    TestRandom rnd;
+
+    for (int i = 0; i < 30000; i++) {
+
+        setupCopyBlit(test, rnd);
+        test.sync();
+
+        Blitter &bl = test.blitter(0);
+        uint16_t con0 = bl.bltcon0, con1 = bl.bltcon1;
+        int w = bl.bltsizeW, h = bl.bltsizeH;
+
+        runCopyBlit(bl);
+        referenceCopyBlit(test.blitter(1), test.mem(1));
+
+        EXPECT(failures, test.sameRegisters(),
+               "Copy blit %d (%04X %04X %dx%d): Registers differ", i, con0, con1, w, h);
+
+        if (i % 64 == 0 || i == 29999) {
+            EXPECT(failures, test.sameMemory(), "Copy blit %d: Chip Ram differs", i);
+            if (failures) {
+                memcpy(test.mem(1).chip, test.mem(0).chip, test.chipSize);
+            }
+        }
+    }
+    return failures;
+}
+
+static void
+benchCopyBlits()
+{
+    BlitterTest test;
+    Blitter &bl = test.blitter(0);
+    Memory &mem = test.mem(0);
+    const int count = 200;
+
+    // A typical blit of a 320 x 200 screen area
+    auto setup = [&](uint16_t con0, uint16_t con1) {
+        bl.bltcon0 = con0; bl.bltcon1 = con1;
+        bl.bltafwm = bl.bltalwm = 0xFFFF;
+        bl.bltsizeW = 20; bl.bltsizeH = 200;
+        bl.bltapt = 0x10000; bl.bltbpt = 0x20000; bl.bltcpt = bl.bltdpt = 0x30000;
+        bl.bltamod = bl.bltbmod = bl.bltcmod = bl.bltdmod = 0;
+    };
+    auto report = [&](const char *name, uint16_t con0, uint16_t con1) {
+        double fast = measure(5, [&]() {
+            for (int i = 0; i < count; i++) { setup(con0, con1); runCopyBlit(bl); } });
+        double slow = measure(5, [&]() {
+            for (int i = 0; i < count; i++) { setup(con0, con1); referenceCopyBlit(bl, mem); } });
+        printf("    %-16s %6.1f us per blit (reference: %6.1f us)\n",
+               name, fast / count / 1000, slow / count / 1000);
+    };
+
+    report("Clear (D):", 0x0100, 0x0000);
+    report("Copy (A, D):", 0x09F0, 0x0000);
+    report("Cookie (ABCD):", 0x4FCA, 0x0000);
+    report("Fill (A, D):", 0x09F0, 0x000A);
+}
+
+long
+testCopyBlits(bool bench)
+{
+    long failures = checkCopyBlits();
+    if (bench) benchCopyBlits();
+    return failures;
+}
+
+//
+// Line blits
+//
+
+// Sets up a line blit the way graphics.library does
+static void
+setupLine(Blitter &bl, int x1, int y1, int x2, int y2, uint8_t mt, bool oneDot)
+{
+    const int bytesPerRow = 80;
+
+    int dx = x2 - x1, dy = y2 - y1;
+    bool xMajor = abs(dx) >= abs(dy);
+    int l = xMajor ? abs(dx) : abs(dy);
+    int s = xMajor ? abs(dy) : abs(dx);
+    int sul = xMajor ? (dy < 0) : (dx < 0);
+    int aul = xMajor ? (dx < 0) : (dy < 0);
+    int octant = (xMajor << 2) | (sul << 1) | aul;
+    int decision = 4 * s - 2 * l;
+
+    bl.bltcon0 = ((x1 & 15) << 12) | 0x0B00 | mt;
+    bl.bltcon1 = ((x1 & 15) << 12) | (octant << 2) | 1;
+    if (decision < 0) bl.bltcon1 |= 0x40;
+    if (oneDot) bl.bltcon1 |= 0x02;
+
+    bl.bltapt = (uint32_t)(int16_t)decision & 0xFFFFFF;
+    bl.bltamod = 4 * (s - l);
+    bl.bltbmod = 4 * s;
+    bl.bltcpt = bl.bltdpt = 0x20000 + y1 * bytesPerRow + (x1 >> 4) * 2;
+    bl.bltcmod = bl.bltdmod = bytesPerRow;
+    bl.anew = 0x8000;
+    bl.bnew = 0xFFFF;
+    bl.bltafwm = bl.bltalwm = 0xFFFF;
+    bl.bltsizeH = l + 1;
+    bl.bltsizeW = 2;
+}
+
+static void
+setupLineBlit(BlitterTest &test, TestRandom &rnd)
+{
+    static const uint8_t minterms[] = { 0xCA, 0x4A, 0xEA, 0x0A, 0xFF, 0x00 };
+    Blitter &bl = test.blitter(0);
+    uint32_t chipSize = test.chipSize;
+
+    if (rnd.next(3) == 0) {
+
+        // Random register contents
+        bl.bltcon0 = rnd.next();
+        bl.bltcon1 = rnd.next() | 1;
+        bl.bltapt = rnd.next() & 0xFFFFFF;
+        bl.bltcpt = rnd.next(chipSize) & ~1;
+        bl.bltdpt = rnd.next(3) ? bl.bltcpt : rnd.next(chipSize) & ~1;
+        bl.bltamod = rnd.next();
+        bl.bltbmod = rnd.next();
+        bl.bltcmod = rnd.next() & ~1;
+        bl.anew = rnd.next();
+        bl.bnew = rnd.next();
+        bl.bltafwm = rnd.next();
+        bl.bltsizeH = 1 + rnd.next(rnd.next(2) ? 20 : 1024);
+
+    } else {
+
+        // Lines in all octants, mostly drawn with common minterms
+        int x1 = rnd.next(640), y1 = rnd.next(256);
+        int x2 = rnd.next(640), y2 = rnd.next(256);
+        if (rnd.next(4) == 0) y2 = y1;
+        if (rnd.next(4) == 0) x2 = x1;
+        if (rnd.next(5) == 0) x2 = MAX(0, x1 + (int)rnd.next(40) - 20);
+
+        setupLine(bl, x1, y1, x2, y2, minterms[rnd.next(6)], rnd.next(3) == 0);
+
+        // Break the assumptions of the span engine now and then
+        if (rnd.next(6) == 0) bl.bnew = rnd.next();
+        if (rnd.next(8) == 0) bl.bltcon0 &= ~0x0200;
+        if (rnd.next(8) == 0) bl.bltcon0 &= ~0x0800;
+        if (rnd.next(8) == 0) bl.bltdpt = bl.bltcpt + 2 * rnd.next(5) - 4;
+        if (rnd.next(8) == 0) bl.bltcon0 = (bl.bltcon0 & 0xFF00) | (uint8_t)rnd.next();
+    }
+    bl.bzero = true;
+    bl.chold = rnd.next();
+}
+
+static long
+checkLineBlits()
+{
+    long failures = 0;
+    BlitterTest test;
+    TestRandom rnd;
+
+    for (int i = 0; i < 100000; i++) {
+
+        setupLineBlit(test, rnd);
+        test.sync();
+
+        Blitter &b0 = test.blitter(0), &b1 = test.blitter(1);
+        uint16_t con0 = b0.bltcon0, con1 = b0.bltcon1;
+        int h = b0.bltsizeH;
+
+        b0.doFastLineBlit();
+        referenceLineBlit(b1, test.mem(1));
+
+        EXPECT(failures, test.sameRegisters() &&
+               b0.bltcon0 == b1.bltcon0 && b0.bltcon1 == b1.bltcon1,
+               "Line blit %d (%04X %04X, %d pixels): Registers differ", i, con0, con1, h);
+
+        if (i % 64 == 0 || i == 99999) {
+            EXPECT(failures, test.sameMemory(), "Line blit %d: Chip Ram differs", i);
+            if (failures) {
+                memcpy(test.mem(1).chip, test.mem(0).chip, test.chipSize);
+            }
+        }
+    }
+    return failures;
+}
+
+static void
+benchLineBlits()
+{
+    BlitterTest test;
+    Blitter &bl = test.blitter(0);
+    Memory &mem = test.mem(0);
+    const int count = 5000;
+
+    struct { const char *name; int x1, y1, x2, y2; } lines[] = {
+
+        { "horizontal:", 0, 10, 319, 10 },
+        { "shallow:", 0, 10, 319, 60 },
+        { "diagonal:", 0, 0, 199, 199 },
+        { "steep:", 10, 0, 40, 199 },
+        { "vertical:", 10, 0, 10, 199 }
+    };
+
+    for (auto &l : lines) {
+
+        double fast = measure(5, [&]() { for (int i = 0; i < count; i++) {
+            setupLine(bl, l.x1, l.y1, l.x2, l.y2, 0xCA, false); bl.doFastLineBlit(); } });
+        double slow = measure(5, [&]() { for (int i = 0; i < count; i++) {
+            setupLine(bl, l.x1, l.y1, l.x2, l.y2, 0xCA, false); referenceLineBlit(bl, mem); } });
+
+        printf("    %-12s %6.0f ns per line (reference: %6.0f ns)\n",
+               l.name, fast / count, slow / count);
+    }
+}
+
+long
+testLineBlits(bool bench)
+{
+    long failures = checkLineBlits();
+    if (bench) benchLineBlits();
+    return failures;
+}
@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+#include "sse_utils.h"
+
+#ifdef __SSSE3__
+
+static const int tableSize = PixelEngine::rgbaIndexCnt;
+
+// Scalar reference (the non-SSE code path of PixelEngine::colorize())
+static void
+colorize(const uint8_t *src, uint32_t *dst, const uint32_t *table, int count)
+{
+    for (int i = 0; i < count; i++) dst[i] = table[src[i]];
+}
+
+/* Fills a line with color register indices. The patterns resemble a blank
+ * line (0), a line with random pixels (1), and a line made of color runs of
+ * varying length (2).
+ */
+static void
+makeLine(uint8_t *line, int length, int pattern, TestRandom &rnd)
+{
+    int run = 1 + (int)rnd.next(40);
+
+    for (int i = 0; i < length; i++) {
+        switch (pattern) {
+            case 0:  line[i] = 5; break;
+            case 1:  line[i] = rnd.next(tableSize); break;
+            default: line[i] = (i / run) % tableSize; break;
+        }
+    }
+}
+
+static long
+checkColorize()
+{
+    long failures = 0;
+    TestRandom rnd;
+
+    uint32_t table[tableSize];
+    for (int i = 0; i < tableSize; i++) table[i] = (uint32_t)rnd.next();
+
+    uint8_t src[HPIXELS];
+    uint32_t dst1[HPIXELS], dst2[HPIXELS];
+
+    for (int i = 0; i < 100000; i++) {
+
+        int pattern = rnd.next(3);
+        int from = rnd.next(32);
+        int count = rnd.next(HPIXELS - from);
+        makeLine(src, HPIXELS, pattern, rnd);
+
+        // Pixels outside the colorized range must stay untouched
+        memset(dst1, 0, sizeof(dst1));
+        memset(dst2, 0, sizeof(dst2));
+        colorizeSSE(src + from, dst1 + from, table, count);
+        colorize(src + from, dst2 + from, table, count);
+
+        EXPECT(failures, memcmp(dst1, dst2, sizeof(dst1)) == 0,
+               "colorizeSSE(pattern %d, from %d, count %d)", pattern, from, count);
+    }
+    return failures;
+}
+
+static void
+benchColorize()
+{
+    const int lines = 20000;
+    TestRandom rnd;
+
+    uint32_t table[tableSize];
+    for (int i = 0; i < tableSize; i++) table[i] = (uint32_t)rnd.next();
+
+    static uint8_t src[HPIXELS];
+    static uint32_t dst[HPIXELS];
+    const char *names[] = { "blank lines:", "random pixels:", "color runs:" };
+
+    for (int pattern = 0; pattern < 3; pattern++) {
+
+        makeLine(src, HPIXELS, pattern, rnd);
+
+        double fast = measure(5, [&]() {
+            for (int i = 0; i < lines; i++) colorizeSSE(src, dst, table, HPIXELS); });
+        double slow = measure(5, [&]() {
+            for (int i = 0; i < lines; i++) colorize(src, dst, table, HPIXELS); });
+
+        printf("    %-15s %6.0f ns per line (scalar: %6.0f ns)\n",
+               names[pattern], fast / lines, slow / lines);
+    }
+}
+
+#endif
+
+long
+testColorize(bool bench)
+{
+    long failures = 0;
+
+#ifdef __SSSE3__
+    failures += checkColorize();
+    if (bench) benchColorize();
+#else
+    (void)bench;
+#endif
+
+    return failures;
+}
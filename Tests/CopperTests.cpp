@@ -0,0 +1,270 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+
+// Reference for Copper::findMatch(): Steps through the beam positions
+static bool
+scanForMatch(Copper &copper, Agnus &agnus, Beam &result)
+{
+    for (Beam b = agnus.pos; b.v < agnus.frameInfo.numLines; ++b) {
+        if (copper.comparator(b)) { result = b; return true; }
+    }
+    return false;
+}
+
+// Sets up a WAIT instruction together with the current beam position
+static void
+setupWait(Amiga &amiga, TestRandom &rnd, uint16_t vmhm)
+{
+    Agnus &agnus = amiga.agnus;
+
+    agnus.copper.cop1ins = (rnd.next() & 0xFFFE) | 1;
+    agnus.copper.cop2ins = vmhm & 0xFFFE;
+    agnus.frameInfo.numLines = 312 + rnd.next(2);
+    agnus.pos.v = rnd.next(agnus.frameInfo.numLines);
+    agnus.pos.h = rnd.next(HPOS_CNT);
+}
+
+static long
+checkFirstMatch()
+{
+    long failures = 0;
+    int16_t next[257];
+
+    for (int mask = 0; mask < 256; mask++) {
+        for (int comp = 0; comp < 256; comp++) {
+
+            if (comp & ~mask) continue;
+
+            // Compute the smallest matching value >= x for all x by a linear scan
+            next[256] = -1;
+            for (int x = 255; x >= 0; x--) {
+                next[x] = ((x & mask) >= comp) ? x : next[x + 1];
+            }
+
+            for (int start = 0; start <= 256; start++) {
+                for (int end : { 0, 57, HPOS_CNT, 256 }) {
+
+                    int16_t expected = (start < end && next[start] < end) ? next[start] : -1;
+                    int16_t result = Copper::firstMatch(start, end, comp, mask);
+
+                    EXPECT(failures, result == expected,
+                           "firstMatch(%d, %d, %02X, %02X) = %d (expected %d)",
+                           start, end, comp, mask, result, expected);
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+static long
+checkFindMatch(Amiga &amiga)
+{
+    long failures = 0;
+    Copper &copper = amiga.agnus.copper;
+    TestRandom rnd;
+
+    auto check = [&]() {
+
+        Beam result(-1, -1), expected(-1, -1);
+        bool found = copper.findMatch(result);
+        bool exists = scanForMatch(copper, amiga.agnus, expected);
+
+        EXPECT(failures,
+               found == exists && (!found || result == expected),
+               "findMatch() at (%d,%d) for %04X %04X in %d lines: "
+               "%d (%d,%d) (expected %d (%d,%d))",
+               amiga.agnus.pos.v, amiga.agnus.pos.h,
+               copper.cop1ins, copper.cop2ins, amiga.agnus.frameInfo.numLines,
+               found, result.v, result.h, exists, expected.v, expected.h);
+    };
+
+    // Run every combination of vertical and horizontal comparison masks
+    for (int vm = 0; vm < 128; vm++) {
+        for (int hm = 0; hm < 128; hm++) {
+            for (int i = 0; i < 4; i++) {
+                setupWait(amiga, rnd, (vm << 8) | (hm << 1));
+                check();
+            }
+        }
+    }
+
+    // Run random WAITs
+    for (int i = 0; i < 20000; i++) {
+        setupWait(amiga, rnd, (uint16_t)rnd.next());
+        check();
+    }
+
+    return failures;
+}
+
+static void
+benchFindMatch(Amiga &amiga)
+{
+    const int count = 20000;
+    Copper &copper = amiga.agnus.copper;
+    Beam result;
+    long sum = 0;
+
+    auto run = [&](bool reference) {
+        TestRandom rnd;
+        for (int i = 0; i < count; i++) {
+            setupWait(amiga, rnd, 0xFFFE);
+            if (reference ? scanForMatch(copper, amiga.agnus, result) : copper.findMatch(result)) {
+                sum += result.v + result.h;
+            }
+        }
+    };
+
+    double fast = measure(5, [&]() { run(false); });
+    double slow = measure(5, [&]() { run(true); });
+
+    printf("    findMatch: %.1f ns per WAIT (beam scan: %.1f ns)\n",
+           fast / count, slow / count);
+}
+
+// Runs the Copper list at 'base' through the decoder and checks the result
+static long
+runDecoder(Amiga &amiga, uint32_t base, int count)
+{
+    Copper &copper = amiga.agnus.copper;
+    Memory &mem = amiga.mem;
+    long failures = 0;
+
+    for (int i = 0; i < count; i++) {
+
+        uint32_t addr = base + 4 * i;
+        copper.cop1ins = mem.peekChip16(addr);
+        copper.cop2ins = mem.peekChip16(addr + 2);
+        const CopperInstr *instr = copper.decodeInstr(addr);
+
+        bool move = !(copper.cop1ins & 1);
+        bool wait = !move && !(copper.cop2ins & 1);
+
+        EXPECT(failures, instr->ins1 == copper.cop1ins && instr->ins2 == copper.cop2ins &&
+               instr->move == move && instr->wait == wait &&
+               (!move || instr->reg == (copper.cop1ins & 0x1FE)),
+               "Decoded %04X %04X at %X as %04X %04X (move: %d wait: %d reg: %X)",
+               copper.cop1ins, copper.cop2ins, addr,
+               instr->ins1, instr->ins2, instr->move, instr->wait, instr->reg);
+    }
+    return failures;
+}
+
+static long
+checkDecodeCache()
+{
+    Amiga *amiga = new Amiga();
+    amiga->configure(VA_CHIP_RAM, 512);
+
+    Copper &copper = amiga->agnus.copper;
+    Blitter &blitter = amiga->agnus.blitter;
+    Memory &mem = amiga->mem;
+    TestRandom rnd;
+    long failures = 0;
+
+    const uint32_t base = 0x1000;
+    const int count = 64;
+
+    for (uint32_t addr = 0; addr < 0x2000; addr += 2) mem.pokeChip16(addr, rnd.next());
+
+    copper.cop1lc = base;
+    copper.switchToCopperList(1);
+    failures += runDecoder(*amiga, base, count);
+
+    EXPECT(failures, copper.cacheCnt[0] == count,
+           "%d instructions cached (expected %d)", copper.cacheCnt[0], count);
+
+    for (int i = 0; i < 20000; i++) {
+
+        // Modify Chip Ram in or around the Copper list
+        uint32_t addr = base - 16 + rnd.next(4 * count + 32);
+        uint32_t bytes = 2;
+
+        switch (rnd.next(5)) {
+
+            case 0:
+
+                mem.poke8(addr, rnd.next());
+                bytes = 1;
+                break;
+
+            case 1:
+
+                addr &= ~1;
+                mem.poke16<BUS_BLITTER>(addr, rnd.next());
+                break;
+
+            case 2:
+
+                addr &= ~1;
+                mem.pokeChip32(addr, rnd.next());
+                bytes = 4;
+                break;
+
+            case 3:
+            {
+                uint8_t buffer[32];
+                rnd.fill(buffer, sizeof(buffer));
+                addr &= ~1;
+                bytes = 2 + 2 * rnd.next(16);
+                mem.pokeChipBlock(addr, buffer, bytes / 2);
+                break;
+            }
+            case 4:
+
+                // Let the Blitter write a row of words via channel D
+                addr &= ~1;
+                bytes = 2 + 2 * rnd.next(16);
+                blitter.bltcon0 = 0x0100 | rnd.next(256);
+                blitter.bltcon1 = rnd.next(2) ? 0x0002 : 0;
+                blitter.bltsizeW = bytes / 2;
+                blitter.bltsizeH = 1;
+                blitter.bltdpt = blitter.bltconDESC() ? addr + bytes - 2 : addr;
+                (blitter.*blitter.blitfunc[2 | blitter.bltconDESC()])();
+                break;
+        }
+
+        // The modified instructions must have been dropped
+        for (uint32_t a = addr & ~1; a < addr + bytes; a += 2) {
+
+            uint32_t instr = base + ((a - base) & ~3);
+            if (a < base || a >= base + 4 * count) continue;
+
+            EXPECT(failures, copper.cachedInstr(instr) == NULL,
+                   "Write to %X did not invalidate the instruction at %X", a, instr);
+        }
+
+        // Rerun the list
+        failures += runDecoder(*amiga, base, count);
+    }
+
+    EXPECT(failures, copper.cacheCnt[0] == count,
+           "%d instructions cached (expected %d)", copper.cacheCnt[0], count);
+
+    delete amiga;
+    return failures;
+}
+
+long
+testCopper(bool bench)
+{
+    Amiga *amiga = new Amiga();
+    long failures = 0;
+
+    failures += checkFirstMatch();
+    failures += checkFindMatch(*amiga);
+    failures += checkDecodeCache();
+    if (bench) benchFindMatch(*amiga);
+
+    delete amiga;
+    return failures;
+}
@@ -0,0 +1,211 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+
+/* Reference implementation of standard disk DMA. The words of a DMA slot are
+ * transferred one by one with two FIFO cycles in between, just as the event
+ * handler would execute them.
+ */
+static void
+referenceDMARead(DiskController &dc, uint32_t remaining)
+{
+    if (!dc.fifoHasWord()) return;
+
+    do {
+        uint16_t word = dc.readFifo16();
+        dc.agnus.doDiskDMA(word);
+        dc.checksum = fnv_1a_it32(dc.checksum, word);
+        dc.checkcnt++;
+
+        if ((--dc.dsklen & 0x3FFF) == 0) {
+            dc.paula.raiseIrq(INT_DSKBLK);
+            dc.state = DRIVE_DMA_OFF;
+            return;
+        }
+        if (--remaining) {
+            dc.executeFifo();
+            dc.executeFifo();
+        }
+    } while (remaining);
+}
+
+static void
+referenceDMAWrite(DiskController &dc, Drive *drive, uint32_t remaining)
+{
+    if (!dc.fifoCanStoreWord()) return;
+
+    do {
+        uint16_t word = dc.agnus.doDiskDMA();
+        dc.checksum = fnv_1a_it32(dc.checksum, word);
+        dc.checkcnt++;
+        dc.writeFifo(HI_BYTE(word));
+        dc.writeFifo(LO_BYTE(word));
+
+        if ((--dc.dsklen & 0x3FFF) == 0) {
+            dc.paula.raiseIrq(INT_DSKBLK);
+            while (!dc.fifoIsEmpty()) drive->writeHead(dc.readFifo());
+            dc.state = DRIVE_DMA_OFF;
+            return;
+        }
+        if (--remaining) {
+            dc.executeFifo();
+            dc.executeFifo();
+        }
+    } while (remaining);
+}
+
+// Creates an emulator with a random disk in the selected drive df0
+static Amiga *
+createAmiga(uint64_t seed, bool write)
+{
+    Amiga *amiga = new Amiga();
+    DiskController &dc = amiga->paula.diskController;
+    TestRandom rnd(seed);
+
+    // Synthetic Kickstart Rom executing an endless loop
+    uint8_t *rom = new uint8_t[KB(256)]();
+    const uint8_t header[] = { 0x11, 0x11, 0x4E, 0xF9, 0x00, 0xF8, 0x00, 0x10 };
+    memcpy(rom, header, sizeof(header));
+    WRITE_16(rom + 0x10, 0x60FE);
+
+    amiga->configure(VA_CHIP_RAM, 512);
+    amiga->mem.loadRomFromBuffer(rom, KB(256));
+    amiga->powerOn();
+    delete[] rom;
+
+    // Fill the disk with random data and plant some SYNC marks
+    Disk *disk = new Disk(DISK_35_DD);
+    rnd.fill(disk->data.raw, sizeof(disk->data.raw));
+    for (int i = 0; i < 2000; i++) {
+        WRITE_16(disk->data.raw + rnd.next(sizeof(disk->data.raw) - 1), 0x4489);
+    }
+    for (Track t = 0; t < Disk::maxTracks; t++) disk->encoded[t] = true;
+    amiga->df0.insertDisk(disk);
+
+    // Select df0 and place the head somewhere on the disk
+    amiga->df0.prb = 0x77;
+    amiga->df0.head.cylinder = (Cylinder)rnd.next(80);
+    amiga->df0.head.side = (Side)rnd.next(2);
+    amiga->df0.head.offset = (uint16_t)rnd.next(Disk::trackSize);
+    dc.selected = 0;
+
+    // Randomize Chip Ram and the DMA registers
+    rnd.fill(amiga->mem.chip, amiga->mem.config.chipSize);
+    amiga->agnus.dskpt = (uint32_t)rnd.next(amiga->mem.config.chipSize) & ~1;
+    amiga->ciaB.imr = rnd.next(2) ? 0x10 : 0;
+    dc.dsksync = rnd.next(4) ? 0x4489 : (uint16_t)rnd.next();
+    dc.dsklen = (write ? 0xC000 : 0x8000) | (uint16_t)(1 + rnd.next(0x3FFF));
+    dc.state = write ? DRIVE_DMA_WRITE : DRIVE_DMA_READ;
+    dc.fifo = rnd.next();
+    dc.fifoCount = (uint8_t)rnd.next(write ? 5 : 7);
+    dc.checksum = fnv_1a_init32();
+    dc.checkcnt = 0;
+
+    return amiga;
+}
+
+// Compares the state that is affected by disk DMA
+static long
+compare(Amiga *bulk, Amiga *ref, const char *mode, uint32_t speed, int step)
+{
+    long failures = 0;
+    DiskController &b = bulk->paula.diskController;
+    DiskController &r = ref->paula.diskController;
+    uint64_t mask = b.fifoCount ? ~0ULL >> (64 - 8 * b.fifoCount) : 0;
+
+    EXPECT(failures, b.fifoCount == r.fifoCount && (b.fifo & mask) == (r.fifo & mask),
+           "%s (speed %u, step %d): FIFO %llx (%d) (expected %llx (%d))",
+           mode, speed, step, (unsigned long long)(b.fifo & mask), b.fifoCount,
+           (unsigned long long)(r.fifo & mask), r.fifoCount);
+    EXPECT(failures, b.syncFlag == r.syncFlag && b.incoming == r.incoming &&
+           b.incomingCycle == r.incomingCycle,
+           "%s (speed %u, step %d): DSKBYTR differs", mode, speed, step);
+    EXPECT(failures, b.checksum == r.checksum && b.checkcnt == r.checkcnt,
+           "%s (speed %u, step %d): Checksum %x (%d) (expected %x (%d))",
+           mode, speed, step, b.checksum, b.checkcnt, r.checksum, r.checkcnt);
+    EXPECT(failures, b.dsklen == r.dsklen && b.state == r.state,
+           "%s (speed %u, step %d): DSKLEN %x state %d (expected %x state %d)",
+           mode, speed, step, b.dsklen, b.state, r.dsklen, r.state);
+    EXPECT(failures, bulk->agnus.dskpt == ref->agnus.dskpt &&
+           bulk->df0.head.offset == ref->df0.head.offset,
+           "%s (speed %u, step %d): DSKPT %x offset %d (expected %x offset %d)",
+           mode, speed, step, bulk->agnus.dskpt, bulk->df0.head.offset,
+           ref->agnus.dskpt, ref->df0.head.offset);
+    EXPECT(failures, bulk->paula.intreq == ref->paula.intreq &&
+           bulk->ciaB.icr == ref->ciaB.icr && bulk->ciaB.delay == ref->ciaB.delay,
+           "%s (speed %u, step %d): INTREQ %x ICR %x (expected %x %x)",
+           mode, speed, step, bulk->paula.intreq, bulk->ciaB.icr,
+           ref->paula.intreq, ref->ciaB.icr);
+
+    return failures;
+}
+
+// Replays random DMA slots with the bulk transfer and the reference
+static long
+replay(uint64_t seed, bool write, uint32_t speed)
+{
+    long failures = 0;
+    const char *mode = write ? "Write" : "Read";
+    Amiga *bulk = createAmiga(seed, write);
+    Amiga *ref = createAmiga(seed, write);
+    DiskController &b = bulk->paula.diskController;
+    DiskController &r = ref->paula.diskController;
+    TestRandom rnd(seed);
+
+    for (int step = 0; step < 200 && b.state != DRIVE_DMA_OFF && !failures; step++) {
+
+        // Perform a DMA slot
+        if (write) {
+            b.performDMAWrite(&bulk->df0, speed);
+            referenceDMAWrite(r, &ref->df0, speed);
+        } else {
+            b.performDMARead(&bulk->df0, speed);
+            referenceDMARead(r, speed);
+        }
+        failures += compare(bulk, ref, mode, speed, step);
+
+        // Let the event handler run a few FIFO cycles until the next slot
+        for (long i = rnd.next(4); i > 0; i--) {
+            b.executeFifo();
+            r.executeFifo();
+        }
+
+        // Acknowledge all interrupts to detect them again
+        bulk->paula.intreq = ref->paula.intreq = 0;
+        bulk->ciaB.icr = ref->ciaB.icr = 0;
+    }
+
+    EXPECT(failures, memcmp(bulk->mem.chip, ref->mem.chip, bulk->mem.config.chipSize) == 0,
+           "%s (speed %u): Chip Ram differs", mode, speed);
+    EXPECT(failures, memcmp(bulk->df0.disk->data.raw, ref->df0.disk->data.raw,
+                            sizeof(bulk->df0.disk->data.raw)) == 0,
+           "%s (speed %u): Disk data differs", mode, speed);
+
+    delete bulk;
+    delete ref;
+    return failures;
+}
+
+long
+testDiskDMA(bool)
+{
+    long failures = 0;
+    const uint32_t speeds[] = { 1, 2, 3, 4, 8, 16, 255, 256, 257, 700 };
+    uint64_t seed = 1;
+
+    for (uint32_t speed : speeds) {
+        for (int i = 0; i < 4; i++) {
+            failures += replay(seed++, false, speed);
+            failures += replay(seed++, true, speed);
+        }
+    }
+
+    return failures;
+}
@@ -0,0 +1,330 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+#include "sse_utils.h"
+
+#include <fcntl.h>
+
+//
+// Scalar reference codec (the non-SSE code paths of class Disk)
+//
+
+static void
+encodeOddEven(uint8_t *target, const uint8_t *source, size_t count)
+{
+    for (size_t i = 0; i < count; i++) target[i] = (source[i] >> 1) & 0x55;
+    for (size_t i = 0; i < count; i++) target[i + count] = source[i] & 0x55;
+}
+
+static void
+decodeOddEven(uint8_t *target, const uint8_t *source, size_t count)
+{
+    for (size_t i = 0; i < count; i++) target[i] = (source[i] & 0x55) << 1;
+    for (size_t i = 0; i < count; i++) target[i] |= source[i + count] & 0x55;
+}
+
+static void
+addClockBits(uint8_t *buffer, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+
+        uint8_t value = buffer[i] & 0x55;
+        uint8_t lShifted = value << 1;
+        uint8_t rShifted = (value >> 1) | (buffer[i - 1] << 7);
+        buffer[i] = value | ((lShifted | rShifted) ^ 0xAA);
+    }
+}
+
+static const uint8_t *
+findSyncMark(const uint8_t *begin, const uint8_t *end)
+{
+    for (const uint8_t *p = begin; p < end; p++) {
+        if (p[0] == 0x44 && p[1] == 0x89 && p[2] == 0x44 && p[3] == 0x89) return p;
+    }
+    return NULL;
+}
+
+#ifdef __SSSE3__
+
+static long
+checkKernels()
+{
+    long failures = 0;
+    TestRandom rnd;
+
+    uint8_t src[1088], enc1[2176], enc2[2176], dec[1088];
+    uint8_t clk1[1089], clk2[1089];
+
+    for (int i = 0; i < 20000; i++) {
+
+        size_t count = 1 + rnd.next(1080);
+        rnd.fill(src, sizeof(src));
+
+        // Odd/even split
+        encodeOddEvenSSE(enc1, src, count);
+        encodeOddEven(enc2, src, count);
+        EXPECT(failures, memcmp(enc1, enc2, 2 * count) == 0,
+               "encodeOddEvenSSE(%zu bytes)", count);
+
+        // Odd/even merge
+        decodeOddEvenSSE(dec, enc1, count);
+        EXPECT(failures, memcmp(dec, src, count) == 0,
+               "decodeOddEvenSSE(%zu bytes)", count);
+
+        // Clock bits (the first byte serves as predecessor)
+        memcpy(clk1, src, count + 1);
+        memcpy(clk2, src, count + 1);
+        addClockBitsSSE(clk1 + 1, count);
+        addClockBits(clk2 + 1, count);
+        EXPECT(failures, memcmp(clk1, clk2, count + 1) == 0,
+               "addClockBitsSSE(%zu bytes)", count);
+
+        // Sync marks at random positions (including the range boundaries)
+        for (int k = rnd.next(4); k > 0; k--) {
+            uint8_t *p = src + rnd.next(sizeof(src) - 3);
+            p[0] = 0x44; p[1] = 0x89; p[2] = 0x44; p[3] = 0x89;
+        }
+        const uint8_t *begin = src + rnd.next(64);
+        const uint8_t *end = begin + rnd.next(src + sizeof(src) - 3 - begin);
+        const uint8_t *found = findSyncMarkSSE(begin, end);
+        const uint8_t *expected = findSyncMark(begin, end);
+        EXPECT(failures, found == expected,
+               "findSyncMarkSSE([%td, %td)) = %td (expected %td)",
+               begin - src, end - src,
+               found ? found - src : -1, expected ? expected - src : -1);
+    }
+    return failures;
+}
+
+static void
+benchKernels()
+{
+    const int rounds = 2000;
+    static uint8_t track[2 * Disk::trackSize], buffer[2 * Disk::trackSize];
+    TestRandom rnd;
+    rnd.fill(track, sizeof(track));
+
+    // Mimic a track with eleven sectors
+    for (int s = 0; s < 11; s++) {
+        uint8_t *p = track + 4 + s * Disk::sectorSize;
+        p[0] = 0x44; p[1] = 0x89; p[2] = 0x44; p[3] = 0x89;
+    }
+
+    auto report = [&](const char *name, double fast, double slow) {
+        printf("    %-18s %7.2f us per track (scalar: %7.2f us)\n",
+               name, fast / rounds / 1000, slow / rounds / 1000);
+    };
+
+    report("encodeOddEven:",
+           measure(5, [&]() { for (int i = 0; i < rounds; i++) for (int s = 0; s < 11; s++)
+               encodeOddEvenSSE(buffer + s * 1024, track + s * 512, 512); }),
+           measure(5, [&]() { for (int i = 0; i < rounds; i++) for (int s = 0; s < 11; s++)
+               encodeOddEven(buffer + s * 1024, track + s * 512, 512); }));
+
+    report("decodeOddEven:",
+           measure(5, [&]() { for (int i = 0; i < rounds; i++) for (int s = 0; s < 11; s++)
+               decodeOddEvenSSE(buffer + s * 512, track + s * 1024, 512); }),
+           measure(5, [&]() { for (int i = 0; i < rounds; i++) for (int s = 0; s < 11; s++)
+               decodeOddEven(buffer + s * 512, track + s * 1024, 512); }));
+
+    report("addClockBits:",
+           measure(5, [&]() { for (int i = 0; i < rounds; i++)
+               addClockBitsSSE(buffer + 1, Disk::trackSize); }),
+           measure(5, [&]() { for (int i = 0; i < rounds; i++)
+               addClockBits(buffer + 1, Disk::trackSize); }));
+
+    long found = 0;
+    report("findSyncMark:",
+           measure(5, [&]() { for (int i = 0; i < rounds; i++) {
+               const uint8_t *end = track + Disk::trackSize;
+               for (const uint8_t *p = track; (p = findSyncMarkSSE(p, end)); p += 4) found++; } }),
+           measure(5, [&]() { for (int i = 0; i < rounds; i++) {
+               const uint8_t *end = track + Disk::trackSize;
+               for (const uint8_t *p = track; (p = findSyncMark(p, end)); p += 4) found++; } }));
+    printf("    %ld sync marks found\n", found);
+}
+
+#endif
+
+// Encodes a random ADF and decodes it back with all tracks marked as modified
+static long
+checkRoundTrip(bool bench)
+{
+    long failures = 0;
+    size_t size = ADFFile::fileSize(DISK_35_DD);
+    uint8_t *buffer = new uint8_t[size];
+    uint8_t *result = new uint8_t[size];
+
+    TestRandom rnd;
+    rnd.fill(buffer, size);
+    ADFFile *adf = ADFFile::makeWithBuffer(buffer, size);
+
+    Disk *disk = Disk::makeWithFile(adf);
+    disk->encodeAllTracks();
+    for (Track t = 0; t < disk->numTracks(); t++) disk->dirty[t] = true;
+
+    ADFFile *decoded = ADFFile::makeWithDisk(disk);
+    EXPECT(failures, decoded != NULL, "ADFFile::makeWithDisk()");
+    if (decoded) {
+        decoded->writeToBuffer(result);
+        EXPECT(failures, memcmp(buffer, result, size) == 0, "Disk round trip");
+    }
+
+    if (bench) {
+        double encode = measure(5, [&]() {
+            Disk *d = Disk::makeWithFile(adf); d->encodeAllTracks(); delete d; });
+        double decode = measure(5, [&]() {
+            ADFFile *f = ADFFile::makeWithDisk(disk); delete f; });
+        printf("    Encoding a disk: %.0f us, decoding all tracks: %.0f us\n",
+               encode / 1000, decode / 1000);
+    }
+
+    delete decoded;
+    delete disk;
+    delete adf;
+    delete [] result;
+    delete [] buffer;
+    return failures;
+}
+
+// Serializes a partially encoded disk and checks the restored copy
+static long
+checkSnapshot()
+{
+    long failures = 0;
+    size_t size = ADFFile::fileSize(DISK_35_DD);
+    uint8_t *buffer = new uint8_t[size];
+    uint8_t *result = new uint8_t[size];
+
+    TestRandom rnd;
+    rnd.fill(buffer, size);
+    ADFFile *adf = ADFFile::makeWithBuffer(buffer, size);
+    Disk *disk = Disk::makeWithFile(adf);
+
+    // Encode a few tracks and modify one of them
+    uint8_t mfm[Disk::trackSize];
+    for (Cylinder c = 13; c >= 10; c--) disk->readBytes(mfm, c, 0, 0, Disk::trackSize);
+    disk->writeBytes(mfm, 10, 0, 0, Disk::trackSize);
+
+    // Serialize the disk and restore it
+    vector<uint8_t> snapshot(disk->serializedSize());
+    SerWriter writer(snapshot.data());
+    disk->serialize(writer);
+    EXPECT(failures, (size_t)(writer.ptr - snapshot.data()) == snapshot.size(),
+           "Serialized %zd bytes (expected %zu)",
+           writer.ptr - snapshot.data(), snapshot.size());
+
+    SerReader reader(snapshot.data());
+    Disk *copy = Disk::makeWithReader(reader, DISK_35_DD);
+
+    // Only the accessed tracks are stored in MFM format
+    for (Track t = 0; t < Disk::maxTracks; t++) {
+
+        bool expected = t >= 20 && t < 28 && t % 2 == 0;
+        EXPECT(failures, copy->encoded[t] == expected && copy->dirty[t] == (t == 20),
+               "Track %ld: encoded = %d, dirty = %d", t, copy->encoded[t], copy->dirty[t]);
+        EXPECT(failures, !expected ||
+               memcmp(disk->data.track[t], copy->data.track[t], Disk::trackSize) == 0,
+               "Track %ld: MFM data differs after restoring", t);
+    }
+
+    // The restored disk decodes to the original data
+    EXPECT(failures, copy->decodeDisk(result) && memcmp(buffer, result, size) == 0,
+           "Restored disk decodes to different data");
+
+    delete copy;
+    delete disk;
+    delete adf;
+    delete [] result;
+    delete [] buffer;
+    return failures;
+}
+
+// Writes modified tracks back to a mapped ADF file
+static long
+checkFlush()
+{
+    long failures = 0;
+    size_t size = ADFFile::fileSize(DISK_35_DD);
+    uint8_t *buffer = new uint8_t[size];
+    uint8_t *result = new uint8_t[size];
+
+    TestRandom rnd;
+    rnd.fill(buffer, size);
+
+    char path[] = "/tmp/vamiga-adf-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, buffer, size) != (ssize_t)size) {
+        printf("    Cannot create %s\n", path);
+        return 1;
+    }
+    close(fd);
+
+    ADFFile *adf = ADFFile::makeWithFile(path);
+    Disk *disk = adf ? Disk::makeWithFile(adf) : NULL;
+    EXPECT(failures, disk && disk->canFlush(), "Cannot map %s", path);
+
+    if (disk && disk->canFlush()) {
+
+        // Rotate track 2 to make the sync marks appear in a different order
+        uint8_t mfm[Disk::trackSize];
+        long shift = 5 * Disk::sectorSize;
+        disk->readBytes(mfm, 1, 0, 0, Disk::trackSize);
+        disk->writeBytes(mfm + shift, 1, 0, 0, Disk::trackSize - shift);
+        disk->writeBytes(mfm, 1, 0, Disk::trackSize - shift, shift);
+
+        // Corrupt a data bit in track 4 and erase track 6
+        disk->readBytes(mfm, 2, 0, 0, Disk::trackSize);
+        mfm[Disk::trackGapSize + 3 * Disk::sectorSize + 100] ^= 0x11;
+        disk->writeBytes(mfm, 2, 0, 0, Disk::trackSize);
+        memset(mfm, 0xAA, Disk::trackSize);
+        disk->writeBytes(mfm, 3, 0, 0, Disk::trackSize);
+
+        EXPECT(failures, !disk->flush(), "Corrupted track has been flushed");
+
+        // Track 2 has been decoded in place, tracks 4 and 6 are untouched
+        fd = open(path, O_RDONLY);
+        EXPECT(failures, fd >= 0 && read(fd, result, size) == (ssize_t)size &&
+               memcmp(buffer, result, size) == 0, "ADF file has been altered");
+        if (fd >= 0) close(fd);
+
+        EXPECT(failures, !disk->dirty[2] && disk->dirty[4] && disk->dirty[6],
+               "Dirty flags: %d %d %d", disk->dirty[2], disk->dirty[4], disk->dirty[6]);
+
+        // Tracks behind the end of a truncated file are read as empty sectors
+        EXPECT(failures, truncate(path, size / 2) == 0, "Cannot truncate %s", path);
+        disk->readBytes(mfm, 70, 0, 0, Disk::trackSize);
+        EXPECT(failures, !disk->canFlush() && !disk->flush(),
+               "Disk is still attached to the truncated file");
+    }
+
+    unlink(path);
+    delete disk;
+    delete adf;
+    delete [] result;
+    delete [] buffer;
+    return failures;
+}
+
+long
+testMfm(bool bench)
+{
+    long failures = 0;
+
+#ifdef __SSSE3__
+    failures += checkKernels();
+    if (bench) benchKernels();
+#endif
+    failures += checkRoundTrip(bench);
+    failures += checkSnapshot();
+    failures += checkFlush();
+
+    return failures;
+}
@@ -0,0 +1,272 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+
+/* The reference implementation keeps a full copy of each recorded state.
+ * The size is chosen to make the states end with a partial 8-byte word.
+ */
+static const size_t stateSize = 4099;
+
+// Modifies a few bytes of a state, sometimes including the last ones
+static void
+modify(TestRandom &rnd, vector<uint8_t> &state)
+{
+    long changes = 1 + rnd.next(24);
+
+    for (long i = 0; i < changes; i++) {
+        size_t offset = rnd.next(state.size());
+        size_t length = 1 + rnd.next(40);
+        length = MIN(length, state.size() - offset);
+        rnd.fill(state.data() + offset, length);
+    }
+    if (rnd.next(4) == 0) state.back() ^= 0x5A;
+}
+
+// Checks that the stored deltas fit into the budget and do not overlap
+static bool
+checkRing(RewindBuffer &rb)
+{
+    size_t total = 0, end = 0;
+    bool wrapped = false;
+
+    for (auto &delta : rb.deltas) {
+
+        if (delta.offset + delta.size > rb.capacity) return false;
+        if (delta.offset < end) {
+            if (wrapped) return false;
+            wrapped = true;
+            if (delta.offset + delta.size > rb.deltas.front().offset) return false;
+        }
+        end = delta.offset + delta.size;
+        total += delta.size;
+    }
+    return total <= rb.capacity;
+}
+
+// Checks the XOR delta of two states by applying it to the newer one
+static long
+checkDeltas()
+{
+    long failures = 0;
+    RewindBuffer rb;
+    TestRandom rnd;
+
+    vector<uint8_t> oldState(stateSize), newState, state;
+    rnd.fill(oldState.data(), stateSize);
+
+    rb.prepare(stateSize);
+    rb.stateSize = stateSize;
+
+    for (int i = 0; i < 200; i++) {
+
+        newState = oldState;
+
+        // Use sparse changes, dense changes and identical states
+        if (i % 10 == 1) rnd.fill(newState.data(), stateSize);
+        else if (i % 10 != 2) modify(rnd, newState);
+
+        size_t size = rb.encode(oldState.data(), newState.data(), rb.encoded);
+        state = newState;
+        rb.apply(rb.encoded, size, state.data());
+
+        EXPECT(failures, state == oldState, "Delta %d does not restore the state", i);
+        EXPECT(failures, (size == 0) == (oldState == newState),
+               "Delta %d: %zu bytes", i, size);
+
+        oldState = newState;
+    }
+
+    return failures;
+}
+
+// Records random states and rewinds them with the history wrapping around
+static long
+checkHistory()
+{
+    long failures = 0;
+    RewindBuffer rb;
+    TestRandom rnd;
+    map<Frame, vector<uint8_t>> recorded;
+    vector<uint8_t> state(stateSize);
+    Frame frame = 0;
+    bool wrapped = false, evicted = false, rewoundAfterWrap = false;
+
+    // Make the budget hold a few dozen deltas only
+    rb.setCapacity(4096);
+    rnd.fill(state.data(), stateSize);
+
+    for (int round = 0; round < 40; round++) {
+
+        // Record a couple of states
+        long n = 1 + rnd.next(30);
+        for (long i = 0; i < n; i++) {
+
+            frame += 1 + rnd.next(3);
+            modify(rnd, state);
+            size_t head = rb.head;
+            memcpy(rb.prepare(stateSize), state.data(), stateSize);
+            rb.commit(frame);
+            recorded[frame] = state;
+            if (rb.head < head) wrapped = true;
+
+            EXPECT(failures, checkRing(rb), "Round %d: Deltas exceed the budget", round);
+        }
+
+        // Evicted states are dropped from the reference, too
+        if (recorded.begin()->first < rb.oldestFrame()) evicted = true;
+        recorded.erase(recorded.begin(), recorded.lower_bound(rb.oldestFrame()));
+        EXPECT(failures, rb.count() == recorded.size(),
+               "Round %d: %zu states stored (expected %zu)",
+               round, rb.count(), recorded.size());
+
+        // Rewinding beyond the history fails and keeps the history intact
+        size_t count = rb.count();
+        EXPECT(failures, rb.rewind(rb.oldestFrame() - 1) == NULL && rb.count() == count,
+               "Round %d: Rewound beyond the history", round);
+
+        // Rewind to a frame between two recorded ones
+        Frame target = frame - rnd.next(frame - rb.oldestFrame() + 1);
+        const uint8_t *restored = rb.rewind(target);
+        auto expected = std::prev(recorded.upper_bound(target));
+
+        EXPECT(failures, restored && memcmp(restored, expected->second.data(), stateSize) == 0,
+               "Round %d: State of frame %lld differs", round, (long long)expected->first);
+        EXPECT(failures, rb.currentFrame == expected->first,
+               "Round %d: Rewound to frame %lld (expected %lld)", round,
+               (long long)rb.currentFrame, (long long)expected->first);
+
+        if (wrapped && expected->first < frame) rewoundAfterWrap = true;
+
+        // Continue recording from the restored state
+        recorded.erase(std::next(expected), recorded.end());
+        state = expected->second;
+        frame = expected->first;
+    }
+
+    // The ring buffer must have wrapped around and evicted old states
+    EXPECT(failures, wrapped && evicted && rewoundAfterWrap,
+           "Ring buffer: wrapped %d, evicted %d, rewound %d",
+           wrapped, evicted, rewoundAfterWrap);
+
+    return failures;
+}
+
+// Checks the budget and the size of the states being changed
+static long
+checkResizing()
+{
+    long failures = 0;
+    RewindBuffer rb;
+    TestRandom rnd;
+    vector<uint8_t> state(stateSize);
+
+    auto record = [&](Frame frame) {
+        modify(rnd, state);
+        memcpy(rb.prepare(state.size()), state.data(), state.size());
+        rb.commit(frame);
+    };
+
+    // Without a budget, only the current state is kept
+    for (Frame f = 1; f <= 10; f++) record(f);
+    EXPECT(failures, rb.count() == 1, "%zu states stored without a budget", rb.count());
+
+    // Changing the budget deletes the history
+    rb.setCapacity(KB(64));
+    EXPECT(failures, rb.count() == 0 && rb.rewind(10) == NULL, "History not deleted");
+
+    for (Frame f = 11; f <= 20; f++) record(f);
+    EXPECT(failures, rb.count() == 10, "%zu states stored (expected 10)", rb.count());
+
+    // A delta exceeding the budget deletes the history
+    rb.setCapacity(64);
+    record(21);
+    rnd.fill(state.data(), state.size());
+    memcpy(rb.prepare(state.size()), state.data(), state.size());
+    rb.commit(22);
+    EXPECT(failures, rb.count() == 1 && rb.oldestFrame() == 22,
+           "Oversized delta: %zu states stored", rb.count());
+
+    // Changing the state size deletes the history
+    rb.setCapacity(KB(64));
+    for (Frame f = 23; f <= 30; f++) record(f);
+    state.resize(stateSize + 8);
+    record(31);
+    EXPECT(failures, rb.count() == 1 && rb.rewind(30) == NULL,
+           "History survived a state size change");
+
+    return failures;
+}
+
+// Records emulator states and steps back in time
+static long
+checkAmiga()
+{
+    long failures = 0;
+    Amiga *amiga = new Amiga();
+    Memory &mem = amiga->mem;
+    TestRandom rnd;
+    map<Frame, vector<uint8_t>> chip;
+    const long interval = 5;
+
+    amiga->configure(VA_CHIP_RAM, 512);
+    amiga->setRewindInterval(interval);
+    amiga->setRewindBudget(KB(32));
+
+    // Record a state in each frame the rewind interval asks for
+    for (int i = 0; i < 400; i++) {
+
+        amiga->agnus.frame++;
+        mem.pokeChip16((uint32_t)rnd.next(mem.config.chipSize) & ~1, (uint16_t)rnd.next());
+
+        if (amiga->rewindIsDue()) {
+            amiga->recordRewindState();
+            chip[amiga->agnus.frame].assign(mem.chip, mem.chip + mem.config.chipSize);
+        }
+    }
+
+    EXPECT(failures, amiga->rewindDepth() > 0 && amiga->rewindDepth() < 400,
+           "Rewind depth is %lld frames", (long long)amiga->rewindDepth());
+
+    // Step back a few times (the history has wrapped around by now)
+    for (int i = 0; i < 5 && amiga->rewindDepth() > 0; i++) {
+
+        Frame target = amiga->agnus.frame - 1 - rnd.next(amiga->rewindDepth());
+        auto expected = std::prev(chip.upper_bound(target));
+
+        EXPECT(failures, amiga->rewind(amiga->agnus.frame - target),
+               "Cannot rewind to frame %lld", (long long)target);
+        EXPECT(failures, amiga->agnus.frame == expected->first &&
+               memcmp(mem.chip, expected->second.data(), expected->second.size()) == 0,
+               "State of frame %lld differs", (long long)expected->first);
+    }
+
+    // Rewinding beyond the history fails and keeps the state
+    Frame frame = amiga->agnus.frame;
+    EXPECT(failures, !amiga->rewind(amiga->rewindDepth() + 1) && amiga->agnus.frame == frame,
+           "Rewound beyond the history");
+
+    // Changing the interval deletes the history
+    amiga->setRewindInterval(interval * 2);
+    EXPECT(failures, amiga->numRewindStates() == 0 && amiga->rewindDepth() == 0,
+           "History survived an interval change");
+
+    delete amiga;
+    return failures;
+}
+
+long
+testRewind(bool)
+{
+    return
+    checkDeltas() +
+    checkHistory() +
+    checkResizing() +
+    checkAmiga();
+}
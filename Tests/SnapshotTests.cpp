@@ -0,0 +1,211 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+
+#include <fcntl.h>
+
+// Number of auto-snapshots taken by the tests
+static const int count = 12;
+
+// Modifies a few Chip Ram words and takes an auto-snapshot
+static void
+takeSnapshot(Amiga *amiga, TestRandom &rnd, vector<uint8_t> &chip)
+{
+    Memory &mem = amiga->mem;
+
+    for (int i = 0; i < 16; i++) {
+        mem.pokeChip16((uint32_t)rnd.next(mem.config.chipSize) & ~1, (uint16_t)rnd.next());
+    }
+    chip.assign(mem.chip, mem.chip + mem.config.chipSize);
+    amiga->takeAutoSnapshot();
+}
+
+// Checks that restoring delta snapshots leaves them stored as deltas
+static long
+checkDeltas()
+{
+    long failures = 0;
+    Amiga *amiga = new Amiga();
+    TestRandom rnd;
+    vector<uint8_t> chip[count];
+
+    amiga->configure(VA_CHIP_RAM, 512);
+    for (int i = 0; i < count; i++) takeSnapshot(amiga, rnd, chip[i]);
+    amiga->waitForSnapshots();
+
+    EXPECT(failures, amiga->numAutoSnapshots() == count,
+           "%zu auto-snapshots stored (expected %d)", amiga->numAutoSnapshots(), count);
+
+    // Restore all snapshots (the newest one is stored at position 0)
+    for (int i = 0; i < (int)amiga->numAutoSnapshots(); i++) {
+
+        amiga->restoreAutoSnapshot(i);
+        shared_ptr<Snapshot> snapshot = amiga->autoSnapshot(i);
+        vector<uint8_t> &expected = chip[count - 1 - i];
+
+        EXPECT(failures, memcmp(amiga->mem.chip, expected.data(), expected.size()) == 0,
+               "Snapshot %d: Chip Ram differs after restoring", i);
+        EXPECT(failures, snapshot->isDelta() && !snapshot->isExpanded(),
+               "Snapshot %d: No longer stored as a delta", i);
+    }
+
+    delete amiga;
+    return failures;
+}
+
+// Checks that the memory used by auto-snapshots is limited
+static long
+checkMemoryLimit()
+{
+    long failures = 0;
+    Amiga *amiga = new Amiga();
+    TestRandom rnd;
+
+    amiga->configure(VA_CHIP_RAM, 512);
+    amiga->configure(VA_FAST_RAM, 8192);
+
+    // Randomize Fast Ram to make each snapshot a new base image
+    for (int i = 0; i < count; i++) {
+        rnd.fill(amiga->mem.fast, amiga->mem.config.fastSize);
+        amiga->takeAutoSnapshot();
+    }
+    amiga->waitForSnapshots();
+
+    size_t bytes = amiga->autoSnapshotBytes();
+    size_t limit = Amiga::MAX_AUTO_SNAPSHOT_BYTES;
+
+    EXPECT(failures, bytes <= limit,
+           "Auto-snapshots occupy %zu bytes (limit %zu)", bytes, limit);
+    EXPECT(failures, amiga->numAutoSnapshots() > 0 && amiga->numAutoSnapshots() < count,
+           "%zu auto-snapshots stored", amiga->numAutoSnapshots());
+
+    delete amiga;
+    return failures;
+}
+
+// Checks that snapshots survive a round trip through the file format
+static long
+checkFileFormat()
+{
+    long failures = 0;
+    Amiga *amiga = new Amiga();
+    TestRandom rnd;
+
+    amiga->configure(VA_CHIP_RAM, 512);
+    rnd.fill(amiga->mem.chip, amiga->mem.config.chipSize / 2);
+    Snapshot *snapshot = Snapshot::makeWithAmiga(amiga);
+
+    // Determine the size first and write the data afterwards
+    size_t size = snapshot->sizeOnDisk();
+    vector<uint8_t> file(size);
+    size_t written = snapshot->writeToBuffer(file.data());
+
+    EXPECT(failures, size > 0 && written == size,
+           "%zu bytes written (expected %zu)", written, size);
+
+    // Compressing the snapshot in a single pass yields the same data
+    vector<uint8_t> compressed;
+    EXPECT(failures, snapshot->writeCompressed(compressed) && compressed == file,
+           "Snapshot compressed in a single pass differs");
+
+    // Writing to a file yields the same data, too
+    char path[] = "/tmp/vamiga-snapshot-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+    vector<uint8_t> onDisk(size);
+    fd = snapshot->writeToFile(path) ? open(path, O_RDONLY) : -1;
+    EXPECT(failures, fd >= 0 && read(fd, onDisk.data(), size) == (ssize_t)size &&
+           read(fd, onDisk.data(), 1) == 0 && onDisk == file,
+           "Snapshot file differs");
+    if (fd >= 0) close(fd);
+    unlink(path);
+
+    // Read the file back and write it again
+    Snapshot *copy = Snapshot::makeWithBuffer(file.data(), file.size());
+    vector<uint8_t> file2(copy ? copy->sizeOnDisk() : 0);
+    if (copy) copy->writeToBuffer(file2.data());
+
+    EXPECT(failures, copy && file == file2, "Rewritten snapshot file differs");
+
+    // Restore the state from the copy
+    vector<uint8_t> buffer, buffer2;
+    uint8_t *core = snapshot->expand(buffer);
+    uint8_t *core2 = copy ? copy->expand(buffer2) : NULL;
+
+    EXPECT(failures, core2 && memcmp(core, core2, amiga->size()) == 0,
+           "Core data differs after reading the snapshot file");
+
+    delete copy;
+    delete snapshot;
+    delete amiga;
+    return failures;
+}
+
+// Checks the snapshots that are finished by the background thread
+static long
+checkBackgroundThread()
+{
+    long failures = 0;
+    Amiga *amiga = new Amiga();
+    TestRandom rnd;
+    vector<uint8_t> chip[2];
+
+    amiga->configure(VA_CHIP_RAM, 512);
+    for (int i = 0; i < 2; i++) takeSnapshot(amiga, rnd, chip[i]);
+    amiga->waitForSnapshots();
+
+    // A snapshot remains valid after it has been deleted from the storage
+    shared_ptr<Snapshot> snapshot = amiga->autoSnapshot(1);
+    amiga->deleteAutoSnapshot(1);
+    vector<uint8_t> buffer;
+    uint8_t *core = snapshot ? snapshot->expand(buffer) : NULL;
+    amiga->restoreAutoSnapshot(0);
+    amiga->loadFromSnapshotUnsafe(snapshot.get());
+
+    EXPECT(failures, core && amiga->numAutoSnapshots() == 1 &&
+           memcmp(amiga->mem.chip, chip[0].data(), chip[0].size()) == 0,
+           "Deleted snapshot could not be restored");
+
+    // User snapshots are inserted by the background thread, too
+    amiga->takeUserSnapshot();
+    amiga->waitForSnapshots();
+
+    EXPECT(failures, amiga->numUserSnapshots() == 1,
+           "%zu user snapshots stored (expected 1)", amiga->numUserSnapshots());
+
+    // Write a snapshot file in the background and read it back
+    char path[] = "/tmp/vamiga-snapshot-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+
+    amiga->saveSnapshotToFile(path);
+    amiga->waitForSnapshots();
+    Snapshot *file = Snapshot::makeWithFile(path);
+    core = file ? file->expand(buffer) : NULL;
+
+    EXPECT(failures, core && memcmp(core, amiga->userSnapshot(0)->expand(buffer),
+                                    amiga->size()) == 0,
+           "Snapshot file does not match the emulator state");
+
+    unlink(path);
+    delete file;
+    delete amiga;
+    return failures;
+}
+
+long
+testSnapshots(bool)
+{
+    return
+    checkDeltas() +
+    checkMemoryLimit() +
+    checkFileFormat() +
+    checkBackgroundThread();
+}
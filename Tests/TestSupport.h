@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _TEST_SUPPORT_INC
+#define _TEST_SUPPORT_INC
+
+#include "Amiga.h"
+
+/* Each test suite compares an optimized code path of the emulator core with
+ * a straightforward reference implementation. A suite returns the number of
+ * failed checks. If 'bench' is true, it additionally times the optimized code
+ * against the reference and prints the results.
+ */
+typedef long (*TestSuite)(bool bench);
+
+long testCopper(bool bench);
+long testMfm(bool bench);
+long testColorize(bool bench);
+long testCopyBlits(bool bench);
+long testLineBlits(bool bench);
+long testTiming(bool bench);
+long testSnapshots(bool bench);
+long testRewind(bool bench);
+long testDiskDMA(bool bench);
+
+// Xorshift generator producing reproducible test data
+class TestRandom {
+
+    uint64_t state;
+
+public:
+
+    TestRandom(uint64_t seed = 99) : state(seed) { }
+
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+    uint64_t next(uint64_t range) { return next() % range; }
+    void fill(uint8_t *buffer, size_t length) {
+        for (size_t i = 0; i < length; i++) buffer[i] = (uint8_t)next();
+    }
+};
+
+// Records a failed check. Only the first few failures of a suite are printed.
+#define EXPECT(failures, cond, ...) \
+if (!(cond)) { \
+    if ((failures)++ < 8) { printf("    FAILED: "); printf(__VA_ARGS__); printf("\n"); } \
+}
+
+// Runs 'func' 'runs' times and returns the fastest run in nanoseconds
+template <class F> double measure(int runs, F func)
+{
+    double best = 0;
+    for (int i = 0; i < runs; i++) {
+        uint64_t start = timeInNanos();
+        func();
+        double elapsed = (double)(timeInNanos() - start);
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+#endif
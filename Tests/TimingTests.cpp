@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "TestSupport.h"
+
+/* Test program placed in a synthetic Kickstart Rom. It switches the motor of
+ * df0 on and off and reads the real-time clock in between. The delay loops
+ * let the CPU run ahead of Agnus if batch execution is enabled.
+ */
+static const uint16_t program[] = {
+
+    0x13FC, 0x00FF, 0x00BF, 0xD100,     // move.b  #$FF,$BFD100
+    0x13FC, 0x007F, 0x00BF, 0xD100,     // move.b  #$7F,$BFD100 (MTR)
+    0x7014,                             // moveq   #20,d0
+    0x5380,                             // subq.l  #1,d0
+    0x66FC,                             // bne.s   *-2
+    0x13FC, 0x0077, 0x00BF, 0xD100,     // move.b  #$77,$BFD100 (MTR, SEL0)
+    0x203C, 0x0000, 0x03E8,             // move.l  #1000,d0
+    0x5380,                             // subq.l  #1,d0
+    0x66FC,                             // bne.s   *-2
+    0x1039, 0x00DC, 0x0001,             // move.b  $DC0001,d0
+    0x203C, 0x0000, 0x01F4,             // move.l  #500,d0
+    0x5380,                             // subq.l  #1,d0
+    0x66FC,                             // bne.s   *-2
+    0x13FC, 0x00FF, 0x00BF, 0xD100,     // move.b  #$FF,$BFD100
+    0x7014,                             // moveq   #20,d0
+    0x5380,                             // subq.l  #1,d0
+    0x66FC,                             // bne.s   *-2
+    0x13FC, 0x00F7, 0x00BF, 0xD100,     // move.b  #$F7,$BFD100 (SEL0)
+    0x203C, 0x0000, 0x00FA,             // move.l  #250,d0
+    0x5380,                             // subq.l  #1,d0
+    0x66FC,                             // bne.s   *-2
+    0x1039, 0x00DC, 0x0003,             // move.b  $DC0003,d0
+    0x60FE                              // bra.s   *
+};
+
+struct TimingResult {
+
+    Cycle motorOn;
+    Cycle motorOff;
+    Cycle rtcRead;
+};
+
+// Runs the test program and records the cycles of the timed accesses
+static TimingResult
+runProgram(bool batch)
+{
+    Amiga *amiga = new Amiga();
+    TimingResult result = { };
+
+    // Reset vectors: SSP (doubling as the Rom header) and PC = $F80010
+    uint8_t *rom = new uint8_t[KB(256)]();
+    const uint8_t header[] = { 0x11, 0x11, 0x4E, 0xF9, 0x00, 0xF8, 0x00, 0x10 };
+    memcpy(rom, header, sizeof(header));
+    for (size_t i = 0; i < sizeof(program) / sizeof(program[0]); i++) {
+        WRITE_16(rom + 0x10 + 2 * i, program[i]);
+    }
+
+    amiga->configure(VA_CHIP_RAM, 512);
+    amiga->configure(VA_RT_CLOCK, RTC_M6242B);
+    amiga->configure(VA_CPU_BATCH, batch);
+
+    if (amiga->mem.loadRomFromBuffer(rom, KB(256))) {
+
+        // Run the emulator on this thread until the frame limit is reached
+        amiga->powerOn();
+        amiga->disableDebugging();
+        amiga->setUnthrottled(true);
+        amiga->stopFrame = amiga->agnus.frame + 2;
+        amiga->runLoop();
+
+        result.motorOn = amiga->df0.motorOnCycle;
+        result.motorOff = amiga->df0.motorOffCycle;
+        result.rtcRead = amiga->rtc.lastCall;
+    }
+
+    delete[] rom;
+    delete amiga;
+    return result;
+}
+
+long
+testTiming(bool)
+{
+    long failures = 0;
+
+    TimingResult stepped = runProgram(false);
+    TimingResult batched = runProgram(true);
+
+    EXPECT(failures, stepped.motorOn > 0 && stepped.motorOff > stepped.motorOn &&
+           stepped.rtcRead > stepped.motorOff,
+           "Test program did not run (motor on: %lld off: %lld RTC: %lld)",
+           (long long)stepped.motorOn, (long long)stepped.motorOff,
+           (long long)stepped.rtcRead);
+
+    EXPECT(failures, batched.motorOn == stepped.motorOn,
+           "Motor on at cycle %lld (expected %lld)",
+           (long long)batched.motorOn, (long long)stepped.motorOn);
+
+    EXPECT(failures, batched.motorOff == stepped.motorOff,
+           "Motor off at cycle %lld (expected %lld)",
+           (long long)batched.motorOff, (long long)stepped.motorOff);
+
+    EXPECT(failures, batched.rtcRead == stepped.rtcRead,
+           "RTC read at cycle %lld (expected %lld)",
+           (long long)batched.rtcRead, (long long)stepped.rtcRead);
+
+    return failures;
+}
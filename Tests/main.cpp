@@ -0,0 +1,65 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+/* Test runner
+ * This program runs the regression tests of the emulator core. Without
+ * arguments, all test suites are run. Otherwise, only the suites named on the
+ * command line are run. Option -b additionally runs the microbenchmarks.
+ * The exit code is nonzero if a check has failed.
+ */
+
+#include "TestSupport.h"
+
+static struct { const char *name; TestSuite func; } suites[] = {
+
+    { "copper",   testCopper },
+    { "mfm",      testMfm },
+    { "colorize", testColorize },
+    { "copyblit", testCopyBlits },
+    { "lineblit", testLineBlits },
+    { "timing",   testTiming },
+    { "snapshot", testSnapshots },
+    { "rewind",   testRewind },
+    { "diskdma",  testDiskDMA }
+};
+
+int
+main(int argc, char *argv[])
+{
+    bool bench = false;
+    int first = 1;
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) { bench = true; first++; }
+
+    long failures = 0;
+    int executed = 0;
+
+    for (auto &suite : suites) {
+
+        // Only run the requested suites
+        bool selected = (first == argc);
+        for (int i = first; i < argc; i++) {
+            if (strcmp(argv[i], suite.name) == 0) selected = true;
+        }
+        if (!selected) continue;
+
+        printf("%s\n", suite.name);
+        long failed = suite.func(bench);
+        printf("%s: %s\n", suite.name, failed ? "FAILED" : "passed");
+
+        failures += failed;
+        executed++;
+    }
+
+    if (executed == 0) {
+        fprintf(stderr, "Usage: %s [-b] [suite ...]\n", argv[0]);
+        return 2;
+    }
+    return failures ? 1 : 0;
+}